@@ -0,0 +1,13 @@
+--
+-- Market prices learned by the auction houses bots, kept across the restarts
+--
+
+CREATE TABLE IF NOT EXISTS `mod_auctionhousebot_market` (
+  `auctionhouse` int(11) unsigned NOT NULL DEFAULT '0' COMMENT 'mapID of the auctionhouse.',
+  `item` int(11) unsigned NOT NULL DEFAULT '0' COMMENT 'Item template.',
+  `time` int(11) unsigned NOT NULL DEFAULT '0' COMMENT 'Time of the last sold or expired auction accounted.',
+  `sum` double NOT NULL DEFAULT '0' COMMENT 'Decayed sum of the per unit prices.',
+  `weight` double NOT NULL DEFAULT '0' COMMENT 'Decayed number of auctions accounted.',
+  `price` bigint(20) unsigned NOT NULL DEFAULT '0' COMMENT 'Market price of a single unit.',
+  PRIMARY KEY (`auctionhouse`, `item`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
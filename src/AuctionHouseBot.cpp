@@ -17,6 +17,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <chrono>
+
 #include "ObjectMgr.h"
 #include "AuctionHouseMgr.h"
 #include "Config.h"
@@ -41,45 +43,163 @@ AuctionHouseBot::AuctionHouseBot(uint32 account, uint32 id)
     _lastrun_h_sec  = time(NULL);
     _lastrun_n_sec  = time(NULL);
 
+    _pendingbids_a  = 0;
+    _pendingbids_h  = 0;
+    _pendingbids_n  = 0;
+
+    _interrupted    = false;
+
     _allianceConfig = NULL;
     _hordeConfig    = NULL;
     _neutralConfig  = NULL;
+
+    _session        = NULL;
+    _AHBplayer      = NULL;
+
+    _actorBuilds    = 0;
+    _actorReuses    = 0;
+    _actorBuildUs   = 0;
+    _actorDestroys  = 0;
+    _actorDestroyUs = 0;
 }
 
 AuctionHouseBot::~AuctionHouseBot()
 {
-    // Nothing
+    DestroyActor();
 }
 
-uint32 AuctionHouseBot::getElement(std::set<uint32> set, int index, uint32 botId, uint32 maxDup, AuctionHouseObject* auctionHouse)
+// =============================================================================
+// Builds the bot player the first time it is needed, then reuses it
+// =============================================================================
+
+void AuctionHouseBot::PrepareActor()
 {
-    std::set<uint32>::iterator it = set.begin();
-    std::advance(it, index);
+    if (_AHBplayer)
+    {
+        _actorReuses++;
+        return;
+    }
 
-    if (maxDup > 0)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::string accountName = "AuctionHouseBot" + std::to_string(_account);
+
+    _session   = new WorldSession(_account, std::move(accountName), 0, nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+    _AHBplayer = new Player(_session);
+    _AHBplayer->Initialize(_id);
+
+    _actorBuilds++;
+    _actorBuildUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AuctionHouseBot::DestroyActor()
+{
+    if (!_AHBplayer)
     {
-        uint32 noStacks = 0;
+        return;
+    }
 
-        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    //
+    // The player is deleted before its session, as it was when both lived on the stack
+    //
+
+    delete _AHBplayer;
+    delete _session;
+
+    _AHBplayer = NULL;
+    _session   = NULL;
+
+    _actorDestroys++;
+    _actorDestroyUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool AuctionHouseBot::hasWork(AHBConfig* config, time_t lastrun, uint32 pendingBids, time_t now)
+{
+    if (!config)
+    {
+        return false;
+    }
+
+    //
+    // The seller has work only while the auction house is below its maximum and some category with items
+    // to sell misses auctions, as seen by the seller itself
+    //
+
+    if (config->AHBSeller && config->GetMaxItems() > 0)
+    {
+        AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+        if (auctionHouse && getNofAuctions(config, auctionHouse, ObjectGuid::Create<HighGuid::Player>(_id)) < config->GetMaxItems())
         {
-            AuctionEntry* Aentry = itr->second;
+            uint32 deficits[AHB_CATEGORIES];
 
-            if (Aentry->owner.GetCounter() == botId)
+            if (getDeficits(config, deficits) > 0)
             {
-                if (*it == Aentry->item_template)
-                {
-                    noStacks++;
-                }
+                return true;
             }
         }
+    }
+
+    //
+    // Otherwise the buyer, when it has bids left or a new interval begins, and something to bid on
+    //
 
-        if (noStacks >= maxDup)
+    if (!config->AHBBuyer || config->GetBuyerCandidates() == 0)
+    {
+        return false;
+    }
+
+    if (pendingBids > 0)
+    {
+        return true;
+    }
+
+    return config->GetBidsPerInterval() > 0 && (now - lastrun) >= time_t(config->GetBiddingInterval() * MINUTE);
+}
+
+uint32 AuctionHouseBot::getDeficits(AHBConfig* config, uint32* deficits)
+{
+    uint32 totalDeficit = config->GetDeficits(deficits);
+
+    //
+    // The categories without items to sell can not be filled, so they miss nothing
+    //
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        if (deficits[category] > 0 && config->GetBin(category).empty())
+        {
+            totalDeficit       -= deficits[category];
+            deficits[category]  = 0;
+        }
+    }
+
+    return totalDeficit;
+}
+
+uint32 AuctionHouseBot::getElement(AHBConfig* config, std::vector<uint32> const& bin, uint32 index, uint32 botId, uint32 maxDup)
+{
+    //
+    // The bins are contiguous, so the pick is a plain index access without copies
+    //
+
+    uint32 itemId = bin[index];
+
+    //
+    // The duplicates are looked up in the index of the bots auctions
+    //
+
+    if (maxDup > 0)
+    {
+        if (config->GetBotItemAuctions(botId, itemId) >= maxDup)
         {
             return 0;
         }
     }
 
-    return *it;
+    return itemId;
 }
 
 uint32 AuctionHouseBot::getStackCount(AHBConfig* config, uint32 max)
@@ -127,19 +247,95 @@ uint32 AuctionHouseBot::getStackCount(AHBConfig* config, uint32 max)
     return urand(1, max);
 }
 
-uint32 AuctionHouseBot::getElapsedTime(uint32 timeClass)
+uint32 AuctionHouseBot::getElapsedTime(AHBConfig* config, time_t now)
 {
-    switch (timeClass)
+    uint32 minTime = 0;
+    uint32 maxTime = 0;
+
+    switch (config->ElapsingTimeClass)
     {
     case 2:
-        return urand(1, 6) * 600;   // SHORT = From 10 to 60 minutes
+        minTime = 600;              // SHORT = From 10 to 60 minutes
+        maxTime = 3600;
+        break;
 
     case 1:
-        return urand(1, 24) * 3600; // MEDIUM = From 1 to 24 hours
+        minTime = 3600;             // MEDIUM = From 1 to 24 hours
+        maxTime = 24 * 3600;
+        break;
 
     default:
-        return urand(24, 72) * 3600; // LONG = From 1 to 3 days
+        minTime = 24 * 3600;        // LONG = From 1 to 3 days
+        maxTime = 72 * 3600;
+        break;
+    }
+
+    //
+    // The duration is drawn to the second, so that the auctions created in the same cycle do not expire together
+    //
+
+    uint32 elapsingTime = urand(minTime, maxTime);
+
+    //
+    // When the minute drawn already holds its share of expirations, draw again a few times and keep the least loaded
+    //
+
+    if (config->ExpiryPerMinute > 0)
+    {
+        uint32 load = config->GetExpiries(now + elapsingTime);
+
+        for (uint32 draw = 0; draw < AUCTION_HOUSE_BOT_EXPIRY_DRAWS && load >= config->ExpiryPerMinute; draw++)
+        {
+            uint32 candidate     = urand(minTime, maxTime);
+            uint32 candidateLoad = config->GetExpiries(now + candidate);
+
+            if (candidateLoad < load)
+            {
+                elapsingTime = candidate;
+                load         = candidateLoad;
+            }
+        }
+
+        //
+        // Still full: move to the nearest minute of the range under the limit, on either side of the duration
+        // drawn. When every minute of the range is full, the least loaded one met is kept.
+        //
+
+        uint32 drawn = elapsingTime;
+
+        for (uint32 step = 1; load >= config->ExpiryPerMinute; step++)
+        {
+            bool inRange = false;
+
+            for (uint32 side = 0; side < 2 && load >= config->ExpiryPerMinute; side++)
+            {
+                uint32 offset = step * MINUTE;
+
+                if (side == 0 ? drawn + offset > maxTime : drawn < minTime + offset)
+                {
+                    continue;
+                }
+
+                uint32 candidate     = side == 0 ? drawn + offset : drawn - offset;
+                uint32 candidateLoad = config->GetExpiries(now + candidate);
+
+                inRange = true;
+
+                if (candidateLoad < load)
+                {
+                    elapsingTime = candidate;
+                    load         = candidateLoad;
+                }
+            }
+
+            if (!inRange)
+            {
+                break;
+            }
+        }
     }
+
+    return elapsingTime;
 }
 
 uint32 AuctionHouseBot::getNofAuctions(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid)
@@ -154,29 +350,17 @@ uint32 AuctionHouseBot::getNofAuctions(AHBConfig* config, AuctionHouseObject* au
     }
 
     //
-    // Just the one handled by the bot
+    // Just the one handled by the bot, as tracked by the auction house hooks
     //
 
-    uint32 count = 0;
-
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
-    {
-        AuctionEntry* Aentry = itr->second;
-
-        if (guid == Aentry->owner)
-        {
-            count++;
-        }
-    }
-
-    return count;
+    return config->GetBotAuctions(guid.GetCounter());
 }
 
 // =============================================================================
 // This routine performs the bidding/buyout operations for the bot
 // =============================================================================
 
-void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* session)
+void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* session, uint32& pendingBids)
 {
     //
     // Check if disabled
@@ -184,81 +368,84 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
 
     if (!config->AHBBuyer)
     {
+        pendingBids = 0;
         return;
     }
 
     //
-    // Retrieve items not owned by the bot and not bought/bidded on by the bot
+    // The auctions not owned by the bots and not bidded on by them are tracked by the auction house hooks,
+    // so no query to the database is needed here.
     //
 
-    QueryResult ahContentQueryResult = CharacterDatabase.Query("SELECT id FROM auctionhouse WHERE houseid={} AND itemowner<>{} AND buyguid<>{}", config->GetAHID(), _id, _id);
-
-    if (!ahContentQueryResult)
+    if (config->GetBuyerCandidates() == 0)
     {
-        return;
-    }
+        if (config->DebugOutBuyer)
+        {
+            LOG_INFO("module", "AHBot [{}]: no auctions to bid on has been recovered", _id);
+        }
 
-    if (ahContentQueryResult->GetRowCount() == 0)
-    {
+        pendingBids = 0;
         return;
     }
 
     if (config->DebugOutBuyer)
     {
-        LOG_INFO("module", "AHBot [{}]: Performing Buy operations for AH={} nbOfAuctions={}", _id, config->GetAHID(), ahContentQueryResult->GetRowCount());
+        LOG_INFO("module", "AHBot [{}]: Performing Buy operations for AH={} nbOfAuctions={}", _id, config->GetAHID(), config->GetBuyerCandidates());
     }
 
+    AuctionHouseObject* auctionHouseObject = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
     //
-    // Fetches content of selected AH to look for possible bids
+    // Perform the operation for a maximum amount of bids attempts configured
     //
 
-    AuctionHouseObject* auctionHouseObject = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
-    std::set<uint32> auctionsGuidsToConsider;
-
-    do
+    if (config->TraceBuyer)
     {
-        uint32 autionGuid = ahContentQueryResult->Fetch()->Get<uint32>();
-        auctionsGuidsToConsider.insert(autionGuid);
-    } while (ahContentQueryResult->NextRow());
+        LOG_INFO("module", "AHBot [{}]: Considering {} auctions to bid on.", _id, pendingBids);
+    }
 
     //
-    // If it's not possible to bid stop here
+    // The candidates are walked at most once per cycle. The cursor only moves forward and the only candidate
+    // dropped while walking is the one just visited, so as many steps as the candidates visit each of them once.
     //
 
-    if (auctionsGuidsToConsider.empty())
+    uint32 candidates = config->GetBuyerCandidates();
+    uint32 visited    = 0;
+
+    while (pendingBids > 0)
     {
-        if (config->DebugOutBuyer)
+        //
+        // If the time available for this update is over, the remaining bids are done in the next ones
+        //
+
+        if (IsTickBudgetExhausted())
         {
-            LOG_INFO("module", "AHBot [{}]: no auctions to bid on has been recovered", _id);
+            _interrupted = true;
+            return;
         }
 
-        return;
-    }
+        //
+        // Prevent to bid again on the same auction: stop once all the candidates have been visited
+        //
 
-    //
-    // Perform the operation for a maximum amount of bids attempts configured
-    //
+        if (visited >= candidates)
+        {
+            pendingBids = 0;
+            return;
+        }
 
-    if (config->TraceBuyer)
-    {
-        LOG_INFO("module", "AHBot [{}]: Considering {} auctions per interval to bid on.", _id, config->GetBidsPerInterval());
-    }
+        pendingBids--;
+        visited++;
 
-    for (uint32 count = 1; count <= config->GetBidsPerInterval(); ++count)
-    {
-        if (auctionsGuidsToConsider.empty()) {
+        uint32 auctionID = config->NextBuyerCandidate();
+
+        if (auctionID == 0)
+        {
+            pendingBids = 0;
             return;
         }
 
-        std::set<uint32>::iterator it = auctionsGuidsToConsider.begin();
-        std::advance(it, 0);
-        uint32 auctionID = *it;
         AuctionEntry* auction = auctionHouseObject->GetAuction(auctionID);
-        
-        //
-        // Prevent to bid again on the same auction
-        //
-        auctionsGuidsToConsider.erase(it);
 
         if (!auction)
         {
@@ -266,6 +453,8 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
             {
                 LOG_ERROR("module", "AHBot [{}]: Auction id: {} Possible entry to buy/bid from AH pool is invalid, this should not happen, moving on next auciton", _id, auctionID);
             }
+
+            config->RemoveBuyerCandidate(auctionID);
             continue;
         }
 
@@ -273,7 +462,7 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
         // Prevent from buying items from the other bots
         //
 
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+        if (IsBot(auction->owner.GetCounter()))
         {
             continue;
         }
@@ -449,6 +638,8 @@ void AuctionHouseBot::Buy(Player* AHBplayer, AHBConfig* config, WorldSession* se
             auction->bidder = AHBplayer->GetGUID();
             auction->bid = bidPrice;
 
+            config->RemoveBuyerCandidate(auction->Id);
+
             sAuctionMgr->GetAuctionHouseSearcher()->UpdateBid(auction);
         
             //
@@ -597,40 +788,12 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
     }
 
     // 
-    // Retrieve the configuration for this run
+    // Compute the deficit of each category for this run: the categories are scheduled
+    // proportionally to how many auctions they miss to reach their maximum.
     // 
 
-    uint32 maxGreyTG   = config->GetMaximum(AHB_GREY_TG);
-    uint32 maxWhiteTG  = config->GetMaximum(AHB_WHITE_TG);
-    uint32 maxGreenTG  = config->GetMaximum(AHB_GREEN_TG);
-    uint32 maxBlueTG   = config->GetMaximum(AHB_BLUE_TG);
-    uint32 maxPurpleTG = config->GetMaximum(AHB_PURPLE_TG);
-    uint32 maxOrangeTG = config->GetMaximum(AHB_ORANGE_TG);
-    uint32 maxYellowTG = config->GetMaximum(AHB_YELLOW_TG);
-
-    uint32 maxGreyI    = config->GetMaximum(AHB_GREY_I);
-    uint32 maxWhiteI   = config->GetMaximum(AHB_WHITE_I);
-    uint32 maxGreenI   = config->GetMaximum(AHB_GREEN_I);
-    uint32 maxBlueI    = config->GetMaximum(AHB_BLUE_I);
-    uint32 maxPurpleI  = config->GetMaximum(AHB_PURPLE_I);
-    uint32 maxOrangeI  = config->GetMaximum(AHB_ORANGE_I);
-    uint32 maxYellowI  = config->GetMaximum(AHB_YELLOW_I);
-
-    uint32 currentGreyTG    = config->GetItemCounts(AHB_GREY_TG);
-    uint32 currentWhiteTG   = config->GetItemCounts(AHB_WHITE_TG);
-    uint32 currentGreenTG   = config->GetItemCounts(AHB_GREEN_TG);
-    uint32 currentBlueTG    = config->GetItemCounts(AHB_BLUE_TG);
-    uint32 currentPurpleTG  = config->GetItemCounts(AHB_PURPLE_TG);
-    uint32 currentOrangeTG  = config->GetItemCounts(AHB_ORANGE_TG);
-    uint32 currentYellowTG  = config->GetItemCounts(AHB_YELLOW_TG);
-
-    uint32 currentGreyItems     = config->GetItemCounts(AHB_GREY_I);
-    uint32 currentWhiteItems    = config->GetItemCounts(AHB_WHITE_I);
-    uint32 currentGreenItems    = config->GetItemCounts(AHB_GREEN_I);
-    uint32 currentBlueItems     = config->GetItemCounts(AHB_BLUE_I);
-    uint32 currentPurpleItems   = config->GetItemCounts(AHB_PURPLE_I);
-    uint32 currentOrangeItems   = config->GetItemCounts(AHB_ORANGE_I);
-    uint32 currentYellowItems   = config->GetItemCounts(AHB_YELLOW_I);
+    uint32 deficits[AHB_CATEGORIES];
+    uint32 totalDeficit = getDeficits(config, deficits);
 
     //
     // Loop variables
@@ -643,6 +806,13 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
     uint32 loopBrk   = 0; // Tracing counter
     uint32 err       = 0; // Tracing counter
 
+    //
+    // The new auctions are written in batches, to limit the number of transactions committed per cycle
+    //
+
+    CharacterDatabaseTransaction trans = nullptr;
+    uint32 nbBatched = 0;
+
     for (uint32 cnt = 1; cnt <= nbItemsToSellThisCycle; cnt++)
     {
         uint32 itemTypeSelectedToSell = 0;
@@ -650,121 +820,68 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         uint32 loopbreaker = 0;
 
         //
-        // Select, in rarity order, a new random item
+        // If the time available for this update is over, stop here. The next cycle restarts from
+        // the auctions counts, which already include what has been sold until now.
         //
 
-        while (itemID == 0 && loopbreaker <= AUCTION_HOUSE_BOT_LOOP_BREAKER)
+        if (IsTickBudgetExhausted())
         {
-            loopbreaker++;
-
-            // Poor
-
-            if ((config->GreyItemsBin.size() > 0) && (currentGreyItems < maxGreyI))
-            {
-                itemTypeSelectedToSell = AHB_GREY_I;
-                itemID = getElement(config->GreyItemsBin, urand(0, config->GreyItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            if (itemID == 0 && (config->GreyTradeGoodsBin.size() > 0) && (currentGreyTG < maxGreyTG))
-            {
-                itemTypeSelectedToSell = AHB_GREY_TG;
-                itemID = getElement(config->GreyTradeGoodsBin, urand(0, config->GreyTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            // Normal
-
-            if (itemID == 0 && (config->WhiteItemsBin.size() > 0) && (currentWhiteItems < maxWhiteI))
-            {
-                itemTypeSelectedToSell = AHB_WHITE_I;
-                itemID = getElement(config->WhiteItemsBin, urand(0, config->WhiteItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            if (itemID == 0 && (config->WhiteTradeGoodsBin.size() > 0) && (currentWhiteTG < maxWhiteTG))
-            {
-                itemTypeSelectedToSell = AHB_WHITE_TG;
-                itemID = getElement(config->WhiteTradeGoodsBin, urand(0, config->WhiteTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
-
-            // Uncommon
-
-            if (itemID == 0 && (config->GreenItemsBin.size() > 0) && (currentGreenItems < maxGreenI))
-            {
-                itemTypeSelectedToSell = AHB_GREEN_I;
-                itemID = getElement(config->GreenItemsBin, urand(0, config->GreenItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+            _interrupted = true;
+            break;
+        }
 
-            if (itemID == 0 && (config->GreenTradeGoodsBin.size() > 0) && (currentGreenTG < maxGreenTG))
-            {
-                itemTypeSelectedToSell = AHB_GREEN_TG;
-                itemID = getElement(config->GreenTradeGoodsBin, urand(0, config->GreenTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+        //
+        // Stop when no category needs more auctions
+        //
 
-            // Rare
+        if (totalDeficit == 0)
+        {
+            binEmpty++;
 
-            if (itemID == 0 && (config->BlueItemsBin.size() > 0) && (currentBlueItems < maxBlueI))
+            if (config->DebugOutSeller)
             {
-                itemTypeSelectedToSell = AHB_BLUE_I;
-                itemID = getElement(config->BlueItemsBin, urand(0, config->BlueItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                LOG_INFO("module", "AHBot [{}]: No category needs more auctions", _id);
             }
 
-            if (itemID == 0 && (config->BlueTradeGoodsBin.size() > 0) && (currentBlueTG < maxBlueTG))
-            {
-                itemTypeSelectedToSell = AHB_BLUE_TG;
-                itemID = getElement(config->BlueTradeGoodsBin, urand(0, config->BlueTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+            break;
+        }
 
-            // Epic
+        //
+        // Select a category weighted by its deficit, then a random item from its bin.
+        // Retries are only needed when the duplicates limit rejects the item.
+        //
 
-            if (itemID == 0 && (config->PurpleItemsBin.size() > 0) && (currentPurpleItems < maxPurpleI))
-            {
-                itemTypeSelectedToSell = AHB_PURPLE_I;
-                itemID = getElement(config->PurpleItemsBin, urand(0, config->PurpleItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+        while (itemID == 0 && loopbreaker <= AUCTION_HOUSE_BOT_LOOP_BREAKER)
+        {
+            loopbreaker++;
 
-            if (itemID == 0 && (config->PurpleTradeGoodsBin.size() > 0) && (currentPurpleTG < maxPurpleTG))
-            {
-                itemTypeSelectedToSell = AHB_PURPLE_TG;
-                itemID = getElement(config->PurpleTradeGoodsBin, urand(0, config->PurpleTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+            uint32 pick = urand(0, totalDeficit - 1);
 
-            // Legendary
+            itemTypeSelectedToSell = 0;
 
-            if (itemID == 0 && (config->OrangeItemsBin.size() > 0) && (currentOrangeItems < maxOrangeI))
+            while (pick >= deficits[itemTypeSelectedToSell])
             {
-                itemTypeSelectedToSell = AHB_ORANGE_I;
-                itemID = getElement(config->OrangeItemsBin, urand(0, config->OrangeItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
+                pick -= deficits[itemTypeSelectedToSell];
+                itemTypeSelectedToSell++;
             }
 
-            if (itemID == 0 && (config->OrangeTradeGoodsBin.size() > 0) && (currentOrangeTG < maxOrangeTG))
-            {
-                itemTypeSelectedToSell = AHB_ORANGE_TG;
-                itemID = getElement(config->OrangeTradeGoodsBin, urand(0, config->OrangeTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+            std::vector<uint32> const& bin = config->GetBin(itemTypeSelectedToSell);
 
-            // Artifact
+            itemID = getElement(config, bin, urand(0, bin.size() - 1), _id, config->DuplicatesCount);
 
-            if (itemID == 0 && (config->YellowItemsBin.size() > 0) && (currentYellowItems < maxYellowI))
-            {
-                itemTypeSelectedToSell = AHB_YELLOW_I;
-                itemID = getElement(config->YellowItemsBin, urand(0, config->YellowItemsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+            //
+            // Draw a second item and keep the one that sold better: the bins get skewed toward the items
+            // the market takes, without starving the ones never tried
+            //
 
-            if (itemID == 0 && (config->YellowTradeGoodsBin.size() > 0) && (currentYellowTG < maxYellowTG))
+            if (itemID != 0 && config->PreferSellingItems && bin.size() > 1)
             {
-                itemTypeSelectedToSell = AHB_YELLOW_TG;
-                itemID = getElement(config->YellowTradeGoodsBin, urand(0, config->YellowTradeGoodsBin.size() - 1), _id, config->DuplicatesCount, auctionHouse);
-            }
+                uint32 otherID = getElement(config, bin, urand(0, bin.size() - 1), _id, config->DuplicatesCount);
 
-            if (itemID == 0)
-            {
-                binEmpty++;
-            
-                if (config->DebugOutSeller)
+                if (otherID != 0 && config->GetSellThrough(otherID) > config->GetSellThrough(itemID))
                 {
-                    LOG_ERROR("module", "AHBot [{}]: No item could be selected from the bins", _id);
+                    itemID = otherID;
                 }
-            
-                break;
             }
         }
 
@@ -792,33 +909,6 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
             continue;
         }
 
-        Item* item = Item::CreateItem(itemID, 1, AHBplayer);
-
-        if (item == NULL)
-        {
-            err++;
-
-            if (config->DebugOutSeller)
-            {
-                LOG_ERROR("module", "AHBot [{}]: could not create item from prototype {}", _id, itemID);
-            }
-
-            continue;
-        }
-
-        // 
-        // Start interacting with the item by adding a random property
-        // 
-
-        item->AddToUpdateQueueOf(AHBplayer);
-
-        uint32 randomPropertyId = Item::GenerateItemRandomPropertyId(itemID);
-
-        if (randomPropertyId != 0)
-        {
-            item->SetItemRandomProperties(randomPropertyId);
-        }
-
         if (prototype->Quality > AHB_MAX_QUALITY)
         {
             err++;
@@ -828,7 +918,6 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
                 LOG_ERROR("module", "AHBot [{}]: Quality {} TOO HIGH for item {}", _id, prototype->Quality, itemID);
             }
 
-            item->RemoveFromUpdateQueueOf(AHBplayer);
             continue;
         }
 
@@ -863,30 +952,75 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         bidPrice    = buyoutPrice * urand(config->GetMinBidPrice(prototype->Quality), config->GetMaxBidPrice(prototype->Quality));
         bidPrice    = bidPrice / 100;
 
+        //
+        // Never ask more than the cheapest player listing of the same item: such an auction could only expire.
+        // The bid keeps its proportion to the buyout.
+        //
+
+        if (config->UndercutCompetition && buyoutPrice > 0)
+        {
+            uint64 lowest = config->GetLowestListing(itemID);
+            uint64 target = lowest * (100 - minValue(config->UndercutPercent, 100u)) / 100;
+
+            if (target > 0 && target < buyoutPrice)
+            {
+                bidPrice    = bidPrice * target / buyoutPrice;
+                buyoutPrice = target;
+            }
+        }
+
         // 
         // Determine the stack size
         // 
 
-        if (config->GetMaxStack(prototype->Quality) > 1 && item->GetMaxStackCount() > 1)
+        if (config->GetMaxStack(prototype->Quality) > 1 && prototype->GetMaxStackSize() > 1)
         {
-            stackCount = minValue(getStackCount(config, item->GetMaxStackCount()), config->GetMaxStack(prototype->Quality));
+            stackCount = minValue(getStackCount(config, prototype->GetMaxStackSize()), config->GetMaxStack(prototype->Quality));
         }
-        else if (config->GetMaxStack(prototype->Quality) == 0 && item->GetMaxStackCount() > 1)
+        else if (config->GetMaxStack(prototype->Quality) == 0 && prototype->GetMaxStackSize() > 1)
         {
-            stackCount = getStackCount(config, item->GetMaxStackCount());
+            stackCount = getStackCount(config, prototype->GetMaxStackSize());
         }
         else
         {
             stackCount = 1;
         }
 
-        item->SetCount(stackCount);
+        // 
+        // Everything is settled from the prototype: only now create the item, with its stack and a random property.
+        // The item gets its owner only after the random property is set: a change made while the bot player owns it
+        // would put it in the update queue of the player, which is kept across the cycles and never flushed.
+        // 
+
+        Item* item = Item::CreateItem(itemID, stackCount);
+
+        if (item == NULL)
+        {
+            err++;
+
+            if (config->DebugOutSeller)
+            {
+                LOG_ERROR("module", "AHBot [{}]: could not create item from prototype {}", _id, itemID);
+            }
+
+            continue;
+        }
+
+        uint32 randomPropertyId = Item::GenerateItemRandomPropertyId(itemID);
+
+        if (randomPropertyId != 0)
+        {
+            item->SetItemRandomProperties(randomPropertyId);
+        }
+
+        item->SetOwnerGUID(AHBplayer->GetGUID());
 
         // 
         // Determine the auction time
         // 
 
-        uint32 elapsingTime = getElapsedTime(config->ElapsingTimeClass);
+        time_t now          = time(NULL);
+        uint32 elapsingTime = getElapsedTime(config, now);
 
         // 
         // Determine the deposit
@@ -898,7 +1032,10 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         // Perform the auction
         // 
 
-        auto trans = CharacterDatabase.BeginTransaction();
+        if (!trans)
+        {
+            trans = CharacterDatabase.BeginTransaction();
+        }
 
         AuctionEntry* auctionEntry      = new AuctionEntry();
         auctionEntry->Id                = sObjectMgr->GenerateAuctionID();
@@ -911,85 +1048,33 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         auctionEntry->buyout            = buyoutPrice * stackCount;
         auctionEntry->bid               = 0;
         auctionEntry->deposit           = deposit;
-        auctionEntry->expire_time       = (time_t)elapsingTime + time(NULL);
+        auctionEntry->expire_time       = (time_t)elapsingTime + now;
         auctionEntry->auctionHouseEntry = ahEntry;
 
         item->SaveToDB(trans);
-        item->RemoveFromUpdateQueueOf(AHBplayer);
         sAuctionMgr->AddAItem(item);
         auctionHouse->AddAuction(auctionEntry);
         auctionEntry->SaveToDB(trans);
 
-        CharacterDatabase.CommitTransaction(trans);
+        config->IncListed(itemTypeSelectedToSell);
 
-        // 
-        // Increments the number of items presents in the auction
-        // 
+        nbBatched++;
 
-        // todo: reread config for actual values, maybe an array to not rely on local count that could potentially be mismatched from config.
-        // config is updated from callback received after auctionHouseObject->AddAuction(auctionEntry);
-        // or maybe reparse the server actual value each update cycle, would need profiling.
-        switch (itemTypeSelectedToSell)
+        if (config->SellerBatchSize > 0 && nbBatched >= config->SellerBatchSize)
         {
-        case AHB_GREY_I:
-            ++currentGreyItems;
-            break;
-
-        case AHB_WHITE_I:
-            ++currentWhiteItems;
-            break;
-
-        case AHB_GREEN_I:
-            ++currentGreenItems;
-            break;
-
-        case AHB_BLUE_I:
-            ++currentBlueItems;
-            break;
-
-        case AHB_PURPLE_I:
-            ++currentPurpleItems;
-            break;
-
-        case AHB_ORANGE_I:
-            ++currentOrangeItems;
-            break;
-
-        case AHB_YELLOW_I:
-            ++currentYellowItems;
-            break;
-
-        case AHB_GREY_TG:
-            ++currentGreyTG;
-            break;
-
-        case AHB_WHITE_TG:
-            ++currentWhiteTG;
-            break;
-
-        case AHB_GREEN_TG:
-            ++currentGreenTG;
-            break;
-
-        case AHB_BLUE_TG:
-            ++currentBlueTG;
-            break;
+            CharacterDatabase.CommitTransaction(trans);
 
-        case AHB_PURPLE_TG:
-            ++currentPurpleTG;
-            break;
+            trans     = nullptr;
+            nbBatched = 0;
+        }
 
-        case AHB_ORANGE_TG:
-            ++currentOrangeTG;
-            break;
+        // 
+        // Consume the deficit of the category; the counters in the config are
+        // updated by the callback received after auctionHouse->AddAuction(auctionEntry)
+        // 
 
-        case AHB_YELLOW_TG:
-            ++currentYellowTG;
-            break;
-
-        default:
-            break;
-        }
+        deficits[itemTypeSelectedToSell]--;
+        totalDeficit--;
 
         nbSold++;
 
@@ -999,6 +1084,15 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
         }
     }
 
+    //
+    // Commit the last partial batch
+    //
+
+    if (trans)
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+
     if (config->TraceSeller)
     {
         LOG_INFO("module", "AHBot [{}]: auctionhouse {}, req={}, sold={}, aboveMin={}, aboveMax={}, loopBrk={}, noNeed={}, tooMany={}, binEmpty={}, err={}", _id, config->GetAHID(), nbItemsToSellThisCycle, nbSold, aboveMin, aboveMax, loopBrk, noNeed, tooMany, binEmpty, err);
@@ -1009,31 +1103,45 @@ void AuctionHouseBot::Sell(Player* AHBplayer, AHBConfig* config)
 // Perform an update cycle
 // =============================================================================
 
-void AuctionHouseBot::Update()
+bool AuctionHouseBot::Update()
 {
     time_t _newrun = time(NULL);
 
+    _interrupted = false;
+
     //
     // If no configuration is associated, then stop here
     //
 
     if (!_allianceConfig && !_hordeConfig && !_neutralConfig)
     {
-        return;
+        return false;
     }
 
     //
-    // Preprare for operation
+    // If neither the seller nor the buyer have something to do, do not touch the bot player at all
     //
 
-    std::string accountName = "AuctionHouseBot" + std::to_string(_account);
+    bool work = hasWork(_neutralConfig, _lastrun_n_sec, _pendingbids_n, _newrun);
+
+    if (!sWorld->getBoolConfig(CONFIG_ALLOW_TWO_SIDE_INTERACTION_AUCTION))
+    {
+        work = work || hasWork(_allianceConfig, _lastrun_a_sec, _pendingbids_a, _newrun) || hasWork(_hordeConfig, _lastrun_h_sec, _pendingbids_h, _newrun);
+    }
 
-    WorldSession _session(_account, std::move(accountName), 0, nullptr, SEC_PLAYER, sWorld->getIntConfig(CONFIG_EXPANSION), 0, LOCALE_enUS, 0, false, false, 0);
+    if (!work)
+    {
+        return false;
+    }
+
+    //
+    // Preprare for operation. The player is registered only while the cycle runs,
+    // so that the world never sees it as an online character (i.e. when saving the players).
+    //
 
-    Player _AHBplayer(&_session);
-    _AHBplayer.Initialize(_id);
+    PrepareActor();
 
-    ObjectAccessor::AddObject(&_AHBplayer);
+    ObjectAccessor::AddObject(_AHBplayer);
 
     LOG_INFO("module", "AHBot [{}]: Begin Performing Update Cycle", _id);
 
@@ -1054,17 +1162,22 @@ void AuctionHouseBot::Update()
                 LOG_INFO("module", "AHBot [{}]: Begin Sell for Alliance...", _id);
             }
 
-            Sell(&_AHBplayer, _allianceConfig);
+            Sell(_AHBplayer, _allianceConfig);
 
             if (((_newrun - _lastrun_a_sec) >= (_allianceConfig->GetBiddingInterval() * MINUTE)) && (_allianceConfig->GetBidsPerInterval() > 0))
+            {
+                _pendingbids_a = _allianceConfig->GetBidsPerInterval();
+                _lastrun_a_sec = _newrun;
+            }
+
+            if (_pendingbids_a > 0)
             {
                 if (_allianceConfig->TraceBuyer)
                 {
                     LOG_INFO("module", "AHBot [{}]: Begin Buy for Alliance...", _id);
                 }
 
-                Buy(&_AHBplayer, _allianceConfig, &_session);
-                _lastrun_a_sec = _newrun;
+                Buy(_AHBplayer, _allianceConfig, _session, _pendingbids_a);
             }
         }
 
@@ -1078,16 +1191,21 @@ void AuctionHouseBot::Update()
             {
                 LOG_INFO("module", "AHBot [{}]: Begin Sell for Horde...", _id);
             }
-            Sell(&_AHBplayer, _hordeConfig);
+            Sell(_AHBplayer, _hordeConfig);
 
             if (((_newrun - _lastrun_h_sec) >= (_hordeConfig->GetBiddingInterval() * MINUTE)) && (_hordeConfig->GetBidsPerInterval() > 0))
+            {
+                _pendingbids_h = _hordeConfig->GetBidsPerInterval();
+                _lastrun_h_sec = _newrun;
+            }
+
+            if (_pendingbids_h > 0)
             {
                 if (_hordeConfig->TraceBuyer)
                 {
                     LOG_INFO("module", "AHBot [{}]: Begin Buy for Horde...", _id);
                 }
-                Buy(&_AHBplayer, _hordeConfig, &_session);
-                _lastrun_h_sec = _newrun;
+                Buy(_AHBplayer, _hordeConfig, _session, _pendingbids_h);
             }
         }
 
@@ -1103,20 +1221,27 @@ void AuctionHouseBot::Update()
         {
             LOG_INFO("module", "AHBot [{}]: Begin Sell for Neutral...", _id);
         }
-        Sell(&_AHBplayer, _neutralConfig);
+        Sell(_AHBplayer, _neutralConfig);
 
         if (((_newrun - _lastrun_n_sec) >= (_neutralConfig->GetBiddingInterval() * MINUTE)) && (_neutralConfig->GetBidsPerInterval() > 0))
+        {
+            _pendingbids_n = _neutralConfig->GetBidsPerInterval();
+            _lastrun_n_sec = _newrun;
+        }
+
+        if (_pendingbids_n > 0)
         {
             if (_neutralConfig->TraceBuyer)
             {
                 LOG_INFO("module", "AHBot [{}]: Begin Buy for Neutral...", _id);
             }
-            Buy(&_AHBplayer, _neutralConfig, &_session);
-            _lastrun_n_sec = _newrun;
+            Buy(_AHBplayer, _neutralConfig, _session, _pendingbids_n);
         }
     }
 
-    ObjectAccessor::RemoveObject(&_AHBplayer);
+    ObjectAccessor::RemoveObject(_AHBplayer);
+
+    return _interrupted;
 }
 
 // =============================================================================
@@ -1259,8 +1384,12 @@ void AuctionHouseBot::Commands(AHBotCommand command, uint32 ahMapID, uint32 col,
             if (itr->second->owner.GetCounter() == _id)
             {
                 // Expired NOW.
+                config->RemoveExpiry(itr->second->expire_time);
+
                 itr->second->expire_time = GameTime::GetGameTime().count();
 
+                config->AddExpiry(itr->second->expire_time);
+
                 uint32 id                = itr->second->Id;
                 uint32 expire_time       = itr->second->expire_time;
 
@@ -1464,6 +1593,12 @@ void AuctionHouseBot::Initialize(AHBConfig* allianceConfig, AHBConfig* hordeConf
     _hordeConfig    = hordeConfig;
     _neutralConfig  = neutralConfig;
 
+    //
+    // Refresh the bot player on reload: it is built again, from a clean state, in the next cycle
+    //
+
+    DestroyActor();
+
     //
     // Done
     //
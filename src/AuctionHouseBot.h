@@ -32,6 +32,7 @@ class  Player;
 class  WorldSession;
 
 #define AUCTION_HOUSE_BOT_LOOP_BREAKER 32
+#define AUCTION_HOUSE_BOT_EXPIRY_DRAWS 8
 
 class AuctionHouseBot
 {
@@ -47,11 +48,33 @@ private:
     time_t     _lastrun_h_sec;
     time_t     _lastrun_n_sec;
 
+    uint32     _pendingbids_a; // Bids of the current interval not yet done
+    uint32     _pendingbids_h;
+    uint32     _pendingbids_n;
+
+    bool       _interrupted;   // The current update ran out of time before its work was done
+
+    //
+    // Bot player, built once and reused across the update cycles
+    //
+
+    WorldSession* _session;
+    Player*       _AHBplayer;
+
+    uint64        _actorBuilds;
+    uint64        _actorReuses;
+    uint64        _actorBuildUs;
+    uint64        _actorDestroys;
+    uint64        _actorDestroyUs;
+
+    void PrepareActor();
+    void DestroyActor();
+
     //
     // Main operations
     //
     void Sell(Player *AHBplayer, AHBConfig *config);
-    void Buy (Player *AHBplayer, AHBConfig *config, WorldSession *session);
+    void Buy (Player *AHBplayer, AHBConfig *config, WorldSession *session, uint32& pendingBids);
 
     //
     // Utilities
@@ -61,19 +84,29 @@ private:
 
     uint32 getNofAuctions(AHBConfig* config, AuctionHouseObject* auctionHouse, ObjectGuid guid);
     uint32 getStackCount(AHBConfig* config, uint32 max);
-    uint32 getElapsedTime(uint32 timeClass);
-    uint32 getElement(std::set<uint32> set, int index, uint32 botId, uint32 maxDup, AuctionHouseObject* auctionHouse);
+    uint32 getElapsedTime(AHBConfig* config, time_t now);
+    uint32 getElement(AHBConfig* config, std::vector<uint32> const& bin, uint32 index, uint32 botId, uint32 maxDup);
+    uint32 getDeficits(AHBConfig* config, uint32* deficits);
+    bool   hasWork(AHBConfig* config, time_t lastrun, uint32 pendingBids, time_t now);
 
 public:
     AuctionHouseBot(uint32 account, uint32 id);
     ~AuctionHouseBot();
 
     void Initialize(AHBConfig* allianceConfig, AHBConfig* hordeConfig, AHBConfig* neutralConfig);
-    void Update();
+    // returns true if the update ran out of time and the bot has to be resumed first in the next one
+    bool Update();
 
     void Commands(AHBotCommand command, uint32 ahMapID, uint32 col, char* args);
 
     ObjectGuid::LowType GetAHBplayerGUID() { return _id; };
+    uint32              GetAccount()       { return _account; };
+
+    uint64 GetActorBuilds()    { return _actorBuilds;    };
+    uint64 GetActorReuses()    { return _actorReuses;    };
+    uint64 GetActorBuildUs()   { return _actorBuildUs;   };
+    uint64 GetActorDestroys()  { return _actorDestroys;  };
+    uint64 GetActorDestroyUs() { return _actorDestroyUs; };
 };
 
 #endif // AUCTION_HOUSE_BOT_H
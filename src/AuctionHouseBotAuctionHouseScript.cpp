@@ -20,37 +20,60 @@ AHBot_AuctionHouseScript::AHBot_AuctionHouseScript() : AuctionHouseScript("AHBot
     AUCTIONHOUSEHOOK_ON_BEFORE_AUCTIONHOUSEMGR_UPDATE
 })
 {
-
+    _nextBot = 0;
 }
 
 void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrSendAuctionSuccessfulMail(
     AuctionHouseMgr*,                /*auctionHouseMgr*/
-    AuctionEntry*,                   /*auction*/
-    Player* owner,
+    AuctionEntry* auction,
+    Player*,                         /*owner*/
     uint32&,                         /*owner_accId*/
     uint32&,                         /*profit*/
     bool& sendNotification,
     bool& updateAchievementCriteria,
-    bool&                            /*sendMail*/)
+    bool& sendMail)
 {
-    if (owner && gBotsId.find(owner->GetGUID().GetCounter()) != gBotsId.end())
+    //
+    // The bots are never online, and the money they earn is of no use: the mail is not even built
+    //
+
+    if (IsBot(auction->owner.GetCounter()))
     {
         sendNotification          = false;
         updateAchievementCriteria = false;
+        sendMail                  = false;
     }
 }
 
 void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrSendAuctionExpiredMail(
     AuctionHouseMgr*,       /* auctionHouseMgr */
-    AuctionEntry*,          /* auction */
-    Player* owner,
+    AuctionEntry* auction,
+    Player*,                /* owner */
     uint32&,                /* owner_accId */
     bool& sendNotification,
-    bool&                   /* sendMail */)
+    bool& sendMail)
 {
-    if (owner && gBotsId.find(owner->GetGUID().GetCounter()) != gBotsId.end())
+    if (!IsBot(auction->owner.GetCounter()))
+    {
+        return;
+    }
+
+    sendNotification = false;
+    sendMail         = false;
+
+    //
+    // Instead of returning the item with a mail that the bot would throw away, release it here. Its row
+    // is deleted with the others released in the same update, the auction row is deleted by the core.
+    //
+
+    Item* item = sAuctionMgr->GetAItem(auction->item_guid);
+
+    if (item)
     {
-        sendNotification = false;
+        sAuctionMgr->RemoveAItem(auction->item_guid);
+        gDisposedItems.push_back(auction->item_guid.GetCounter());
+
+        delete item;
     }
 }
 
@@ -64,6 +87,33 @@ void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrSendAuctionOutbiddedMail(
     bool&,                 /* sendNotification */
     bool&                  /* sendMail */)
 {
+    //
+    // A player outbidded a bot: the auction can be considered again by the buyer
+    //
+
+    if (newBidder && IsBot(auction->bidder.GetCounter()))
+    {
+        if (!IsBot(newBidder->GetGUID().GetCounter()))
+        {
+            AuctionHouseEntry const* ahEntry = sAuctionMgr->GetAuctionHouseEntryFromHouse(auction->GetHouseId());
+            AHBConfig* config = gNeutralConfig;
+
+            if (ahEntry)
+            {
+                if (AuctionHouseId(ahEntry->houseId) == AuctionHouseId::Alliance)
+                {
+                    config = gAllianceConfig;
+                }
+                else if (AuctionHouseId(ahEntry->houseId) == AuctionHouseId::Horde)
+                {
+                    config = gHordeConfig;
+                }
+            }
+
+            config->AddBuyerCandidate(auction->Id);
+        }
+    }
+
     if (oldBidder && !newBidder)
     {
         if (gBotsId.size() > 0)
@@ -108,13 +158,32 @@ void AHBot_AuctionHouseScript::OnAuctionAdd(AuctionHouseObject* /*ah*/, AuctionE
         }
     }
 
+    //
+    // Keeps updated the index of the auctions owned by the bots, the ones the buyer can bid on and the players prices
+    //
+
+    if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+    {
+        config->IncBotAuctions(auction->owner.GetCounter(), auction->item_template);
+        config->AddExpiry(auction->expire_time);
+    }
+    else if (!IsBot(auction->owner.GetCounter()))
+    {
+        if (!IsBot(auction->bidder.GetCounter()))
+        {
+            config->AddBuyerCandidate(auction->Id);
+        }
+
+        config->AddListing(auction->item_template, auction->itemCount, auction->buyout);
+    }
+
     //
     // Consider only those auctions handled by the bots
     //
 
     if (config->ConsiderOnlyBotAuctions)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+        if (IsBot(auction->owner.GetCounter()))
         {
             return;
         }
@@ -171,10 +240,34 @@ void AHBot_AuctionHouseScript::OnAuctionRemove(AuctionHouseObject* /*ah*/, Aucti
         }
     }
 
+    // Keeps updated the index of the auctions owned by the bots, the ones the buyer can bid on and the players prices
+    if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+    {
+        config->DecBotAuctions(auction->owner.GetCounter(), auction->item_template);
+        config->RemoveExpiry(auction->expire_time);
+    }
+    else if (!IsBot(auction->owner.GetCounter()))
+    {
+        config->RemoveListing(auction->item_template, auction->itemCount, auction->buyout);
+    }
+
+    //
+    // A bot removed by a reload stops being one when its last auction is gone
+    //
+
+    std::map<uint32, uint32>::iterator retired = gRetiredBots.find(auction->owner.GetCounter());
+
+    if (retired != gRetiredBots.end() && --retired->second == 0)
+    {
+        gRetiredBots.erase(retired);
+    }
+
+    config->RemoveBuyerCandidate(auction->Id);
+
     // Consider only those auctions handled by the bots
     if (config->ConsiderOnlyBotAuctions)
     {
-        if (gBotsId.find(auction->owner.GetCounter()) != gBotsId.end())
+        if (IsBot(auction->owner.GetCounter()))
         {
             return;
         }
@@ -234,6 +327,15 @@ void AHBot_AuctionHouseScript::OnAuctionSuccessful(AuctionHouseObject* /*ah*/, A
 
     config->UpdateItemStats(auction->item_template, auction->itemCount, auction->buyout);
 
+    //
+    // Keeps track of which items listed by the bots actually sell
+    //
+
+    if (IsBot(auction->owner.GetCounter()))
+    {
+        config->UpdateSellThrough(auction->item_template, true);
+    }
+
 }
 
 void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, AuctionEntry* auction)
@@ -265,9 +367,18 @@ void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, Aucti
     //
     // If the auction expired, then it means that the bid was unwanted by the market.
     // Bid price is usually less or equal to the buyout, so this likely will bring the price down.
+    // Without any bid there is no price to learn from: the expiry only counts against the sell-through.
     //
 
-    config->UpdateItemStats(auction->item_template, auction->itemCount, auction->bid);
+    if (auction->bid > 0)
+    {
+        config->UpdateItemStats(auction->item_template, auction->itemCount, auction->bid);
+    }
+
+    if (IsBot(auction->owner.GetCounter()))
+    {
+        config->UpdateSellThrough(auction->item_template, false);
+    }
 
     if (config->DebugOut)
     {
@@ -278,11 +389,63 @@ void AHBot_AuctionHouseScript::OnAuctionExpire(AuctionHouseObject* /*ah*/, Aucti
 void AHBot_AuctionHouseScript::OnBeforeAuctionHouseMgrUpdate()
 {
     //
-    // For every registered bot, perform an update
+    // For every registered bot, perform an update within the time budget.
+    // The bots are served starting from where the previous tick stopped, so that none of them starves.
+    //
+
+    gTickStart = std::chrono::steady_clock::now();
+    gTicks++;
+
+    //
+    // Write behind the market prices changed since the last save, when due
+    //
+
+    gAllianceConfig->SaveMarket(false);
+    gHordeConfig   ->SaveMarket(false);
+    gNeutralConfig ->SaveMarket(false);
+
+    //
+    // Delete the items of the bots auctions expired during the previous update
     //
 
-    for (AuctionHouseBot* bot: gBots)
+    FlushDisposedItems(false);
+
+    if (gBots.empty())
+    {
+        return;
+    }
+
+    if (_nextBot >= gBots.size())
     {
-        bot->Update();
+        _nextBot = 0;
+    }
+
+    std::set<AuctionHouseBot*>::iterator it = std::next(gBots.begin(), _nextBot);
+
+    for (uint32 served = 0; served < gBots.size(); ++served)
+    {
+        //
+        // A bot interrupted by the end of the budget is resumed first in the next tick; a bot that completed
+        // its work passes the turn, even if it used up the budget, so that the ones after it are served next
+        //
+
+        if ((*it)->Update())
+        {
+            return;
+        }
+
+        _nextBot++;
+        it++;
+
+        if (it == gBots.end())
+        {
+            _nextBot = 0;
+            it       = gBots.begin();
+        }
+
+        if (IsTickBudgetExhausted())
+        {
+            return;
+        }
     }
 }
@@ -14,6 +14,9 @@
 
 class AHBot_AuctionHouseScript : public AuctionHouseScript
 {
+private:
+    uint32 _nextBot; // Position of the first bot to update in the next tick
+
 public:
     AHBot_AuctionHouseScript();
 
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include "ObjectMgr.h"
+#include "QueryResult.h"
+#include "StringFormat.h"
+
+#include "AuctionHouseBotBinsCache.h"
+#include "AuctionHouseBotCommon.h"
+
+//
+// Layout of the file, in the native byte order:
+//
+//   magic, version, sources key
+//   npc items, loot items, disabled items       (words count + bitmap words)
+//   bins count
+//   for each bins: filters hash, 14 categories  (ids count + ids)
+//
+
+static constexpr uint32 CacheMagic   = 0x43424841; // "AHBC"
+static constexpr uint32 CacheVersion = 2;
+static constexpr uint32 MaxSetWords  = (1 << 24) / 64;
+
+//
+// Sequential reader over the content of the file; every read is bounds checked so that a truncated or damaged file is simply refused
+//
+
+class AHBCacheReader
+{
+private:
+    std::vector<char> const& _data;
+    size_t                   _pos;
+
+public:
+    AHBCacheReader(std::vector<char> const& data) : _data(data), _pos(0)
+    {
+
+    }
+
+    template<class T>
+    bool Read(T& value)
+    {
+        if (_data.size() - _pos < sizeof(T))
+        {
+            return false;
+        }
+
+        std::memcpy(&value, _data.data() + _pos, sizeof(T));
+        _pos += sizeof(T);
+
+        return true;
+    }
+
+    template<class T>
+    bool ReadVector(std::vector<T>& values, uint32 maxCount)
+    {
+        uint32 count = 0;
+
+        if (!Read(count) || count > maxCount || (_data.size() - _pos) / sizeof(T) < count)
+        {
+            return false;
+        }
+
+        values.resize(count);
+
+        if (count > 0)
+        {
+            std::memcpy(values.data(), _data.data() + _pos, count * sizeof(T));
+            _pos += count * sizeof(T);
+        }
+
+        return true;
+    }
+
+    bool ReadSet(AHBItemSet& set)
+    {
+        std::vector<uint64> words;
+
+        if (!ReadVector(words, MaxSetWords))
+        {
+            return false;
+        }
+
+        set.Assign(std::move(words));
+
+        return true;
+    }
+
+    bool AtEnd()
+    {
+        return _pos == _data.size();
+    }
+};
+
+template<class T>
+static void CacheWrite(std::ofstream& out, T value)
+{
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template<class T>
+static void CacheWriteVector(std::ofstream& out, std::vector<T> const& values)
+{
+    CacheWrite(out, uint32(values.size()));
+
+    if (!values.empty())
+    {
+        out.write(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(T));
+    }
+}
+
+uint64 AHBBinsCache::GetSourcesKey(bool professionItems)
+{
+    uint64 hash = 14695981039346656037ULL;
+
+    auto mix = [&hash](uint64 value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+
+    mix(CacheVersion);
+    mix(professionItems);
+
+    //
+    // Content of the tables the sources are loaded from: each table is summarized by its rows count and
+    // by the xor of the checksums of its rows, a plain scan much cheaper than the union of the loot tables
+    // it replaces. The xor does not depend on the order of the rows, and changes with any edited row.
+    //
+
+    auto digest = [](char const* table, char const* columns)
+    {
+        return Acore::StringFormat("SELECT COUNT(*), COALESCE(BIT_XOR(CRC32(CONCAT_WS(',', {}))), 0) FROM {}", columns, table);
+    };
+
+    std::string query =
+        digest("mod_auctionhousebot_disabled_items", "item")        + " UNION ALL " +
+        digest("npc_vendor"                        , "entry, item") + " UNION ALL " +
+        digest("creature_loot_template"            , "entry, item") + " UNION ALL " +
+        digest("reference_loot_template"           , "entry, item") + " UNION ALL " +
+        digest("disenchant_loot_template"          , "entry, item") + " UNION ALL " +
+        digest("fishing_loot_template"             , "entry, item") + " UNION ALL " +
+        digest("gameobject_loot_template"          , "entry, item") + " UNION ALL " +
+        digest("item_loot_template"                , "entry, item") + " UNION ALL " +
+        digest("milling_loot_template"             , "entry, item") + " UNION ALL " +
+        digest("pickpocketing_loot_template"       , "entry, item") + " UNION ALL " +
+        digest("prospecting_loot_template"         , "entry, item") + " UNION ALL " +
+        digest("skinning_loot_template"            , "entry, item");
+
+    if (professionItems)
+    {
+        query += " UNION ALL " + digest("auctionhousebot_professionItems", "entry, item");
+    }
+
+    QueryResult result = WorldDatabase.Query(query);
+
+    if (!result)
+    {
+        return 0;
+    }
+
+    do
+    {
+        Field* fields = result->Fetch();
+
+        mix(uint64(fields[0].Get<int64>()));
+        mix(fields[1].Get<uint64>());
+    } while (result->NextRow());
+
+    //
+    // Digest of the item templates fields read by the filters. The store is unordered, so the
+    // digests of the single templates are summed to be independent from the iteration order.
+    //
+
+    ItemTemplateContainer const* its = sObjectMgr->GetItemTemplateStore();
+
+    uint64 templates = 0;
+
+    for (ItemTemplateContainer::const_iterator itr = its->begin(); itr != its->end(); ++itr)
+    {
+        ItemTemplate const& proto = itr->second;
+
+        uint64 digest = 14695981039346656037ULL;
+
+        for (uint64 value : { uint64(proto.ItemId)       , uint64(proto.Class)         , uint64(proto.SubClass)         , uint64(proto.Quality),
+                              uint64(proto.Flags)        , uint64(proto.BuyPrice)      , uint64(proto.SellPrice)        , uint64(proto.AllowableClass),
+                              uint64(proto.ItemLevel)    , uint64(proto.RequiredLevel) , uint64(proto.RequiredSkillRank), uint64(proto.MinMoneyLoot),
+                              uint64(proto.Duration)     , uint64(proto.Bonding) })
+        {
+            digest ^= value;
+            digest *= 1099511628211ULL;
+        }
+
+        templates += digest;
+    }
+
+    mix(its->size());
+    mix(templates);
+
+    return hash;
+}
+
+bool AHBBinsCache::Load(std::string const& path, uint64 sourcesKey, std::shared_ptr<AHBSources const>& sources, std::map<uint64, std::shared_ptr<AHBBins const>>& bins)
+{
+    std::ifstream in(path, std::ios::binary);
+
+    if (!in)
+    {
+        return false;
+    }
+
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    AHBCacheReader reader(data);
+
+    uint32 magic   = 0;
+    uint32 version = 0;
+    uint64 key     = 0;
+
+    if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(key) || magic != CacheMagic || version != CacheVersion)
+    {
+        LOG_ERROR("module", "AHBot: bins cache {} is not valid, it will be rebuilt", path);
+        return false;
+    }
+
+    if (key != sourcesKey)
+    {
+        LOG_INFO("module", "AHBot: bins cache {} is out of date, it will be rebuilt", path);
+        return false;
+    }
+
+    //
+    // Sources
+    //
+
+    std::shared_ptr<AHBSources> loaded = AHBConfig::NewSources();
+
+    if (!reader.ReadSet(loaded->NpcItems) || !reader.ReadSet(loaded->LootItems) || !reader.ReadSet(loaded->DisableItemStore))
+    {
+        LOG_ERROR("module", "AHBot: bins cache {} is truncated, it will be rebuilt", path);
+        return false;
+    }
+
+    //
+    // Bins
+    //
+
+    std::map<uint64, std::shared_ptr<AHBBins const>> loadedBins;
+
+    uint32 count = 0;
+
+    if (!reader.Read(count))
+    {
+        LOG_ERROR("module", "AHBot: bins cache {} is truncated, it will be rebuilt", path);
+        return false;
+    }
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        uint64                   filtersHash = 0;
+        std::shared_ptr<AHBBins> entry       = std::make_shared<AHBBins>();
+
+        if (!reader.Read(filtersHash))
+        {
+            LOG_ERROR("module", "AHBot: bins cache {} is truncated, it will be rebuilt", path);
+            return false;
+        }
+
+        for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+        {
+            if (!reader.ReadVector(entry->Bin[category], uint32(data.size())))
+            {
+                LOG_ERROR("module", "AHBot: bins cache {} is truncated, it will be rebuilt", path);
+                return false;
+            }
+        }
+
+        loadedBins[filtersHash] = entry;
+    }
+
+    if (!reader.AtEnd())
+    {
+        LOG_ERROR("module", "AHBot: bins cache {} is not valid, it will be rebuilt", path);
+        return false;
+    }
+
+    sources = loaded;
+    bins    = std::move(loadedBins);
+
+    LOG_INFO("module", "AHBot: loaded the items sources and {} bins from the cache {}", uint32(bins.size()), path);
+
+    return true;
+}
+
+void AHBBinsCache::Save(std::string const& path, uint64 sourcesKey, AHBSources const& sources, std::map<uint64, std::shared_ptr<AHBBins const>> const& bins)
+{
+    //
+    // Write aside and rename, so that a crash in the middle never leaves a partial file behind
+    //
+
+    std::string temp = path + ".tmp";
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+
+        if (!out)
+        {
+            LOG_ERROR("module", "AHBot: could not write the bins cache {}", temp);
+            return;
+        }
+
+        CacheWrite(out, CacheMagic);
+        CacheWrite(out, CacheVersion);
+        CacheWrite(out, sourcesKey);
+
+        CacheWriteVector(out, sources.NpcItems.Words());
+        CacheWriteVector(out, sources.LootItems.Words());
+        CacheWriteVector(out, sources.DisableItemStore.Words());
+
+        CacheWrite(out, uint32(bins.size()));
+
+        for (std::map<uint64, std::shared_ptr<AHBBins const>>::const_iterator it = bins.begin(); it != bins.end(); ++it)
+        {
+            CacheWrite(out, it->first);
+
+            for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+            {
+                CacheWriteVector(out, it->second->Bin[category]);
+            }
+        }
+
+        if (!out)
+        {
+            LOG_ERROR("module", "AHBot: could not write the bins cache {}", temp);
+            return;
+        }
+    }
+
+    //
+    // The rename replaces the previous cache atomically, except on Windows where the target has to go first
+    //
+
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+
+    if (std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR("module", "AHBot: could not replace the bins cache {}", path);
+        return;
+    }
+
+    LOG_INFO("module", "AHBot: saved the items sources and {} bins to the cache {}", uint32(bins.size()), path);
+}
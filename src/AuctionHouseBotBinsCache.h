@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_BINS_CACHE_H
+#define AUCTION_HOUSE_BOT_BINS_CACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Common.h"
+
+#include "AuctionHouseBotConfig.h"
+
+// =============================================================================
+// On disk cache of the items sources and of the bins built from them, so that
+// a restart with unchanged tables and filters skips the loot queries and the
+// filtering pass over the item templates.
+//
+// The file is keyed by the content of the tables the sources come from (rows
+// count and checksum of the rows of each table, plus a digest of the
+// templates), and
+// each set of bins by the hash of the filters that produced it.
+// =============================================================================
+
+class AHBBinsCache
+{
+public:
+    static uint64 GetSourcesKey(bool professionItems);
+
+    static bool   Load(std::string const& path, uint64 sourcesKey, std::shared_ptr<AHBSources const>& sources, std::map<uint64, std::shared_ptr<AHBBins const>>& bins);
+    static void   Save(std::string const& path, uint64 sourcesKey, AHBSources const& sources, std::map<uint64, std::shared_ptr<AHBBins const>> const& bins);
+};
+
+#endif // AUCTION_HOUSE_BOT_BINS_CACHE_H
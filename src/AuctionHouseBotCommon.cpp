@@ -2,6 +2,9 @@
  * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
  */
 
+#include "DatabaseEnv.h"
+#include "StringFormat.h"
+
 #include "AuctionHouseBot.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
@@ -20,3 +23,74 @@ AHBConfig* gNeutralConfig  = new AHBConfig(7);
 
 std::set<uint32>           gBotsId;
 std::set<AuctionHouseBot*> gBots;
+
+std::map<uint32, uint32>   gRetiredBots;
+
+bool IsBot(uint32 playerId)
+{
+    return gBotsId.find(playerId) != gBotsId.end() || gRetiredBots.find(playerId) != gRetiredBots.end();
+}
+
+// 
+// Time budget of a single auction house update
+// 
+
+uint32                                gTickBudgetUs = 0;
+std::chrono::steady_clock::time_point gTickStart;
+uint64                                gTicks        = 0;
+
+bool IsTickBudgetExhausted()
+{
+    if (gTickBudgetUs == 0)
+    {
+        return false;
+    }
+
+    return (std::chrono::steady_clock::now() - gTickStart) >= std::chrono::microseconds(gTickBudgetUs);
+}
+
+// 
+// Items released by the bots expired auctions
+// 
+
+std::vector<uint32> gDisposedItems;
+
+void FlushDisposedItems(bool shutdown)
+{
+    if (gDisposedItems.empty())
+    {
+        return;
+    }
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+
+    for (size_t first = 0; first < gDisposedItems.size(); first += 256)
+    {
+        std::string query = "DELETE FROM item_instance WHERE guid IN (";
+
+        for (size_t i = first; i < gDisposedItems.size() && i < first + 256; i++)
+        {
+            if (i > first)
+            {
+                query += ", ";
+            }
+
+            query += Acore::StringFormat("{}", gDisposedItems[i]);
+        }
+
+        query += ")";
+
+        trans->Append(query);
+    }
+
+    if (shutdown)
+    {
+        CharacterDatabase.DirectCommitTransaction(trans);
+    }
+    else
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+
+    gDisposedItems.clear();
+}
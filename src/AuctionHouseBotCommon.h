@@ -20,7 +20,10 @@
 #ifndef AUCTION_HOUSE_BOT_COMMON_H
 #define AUCTION_HOUSE_BOT_COMMON_H
 
+#include <chrono>
+#include <map>
 #include <set>
+#include <vector>
 
 #include "Common.h"
 
@@ -72,6 +75,7 @@ class AuctionHouseBot;
 #define AHB_YELLOW_I         13
 
 #define AHB_ITEM_TYPE_OFFSET 7
+#define AHB_CATEGORIES       14
 
 //
 // Chat GM commands
@@ -104,4 +108,18 @@ enum class AHBotCommand : uint32
 extern std::set<uint32>           gBotsId; // Active bots players ids
 extern std::set<AuctionHouseBot*> gBots;   // Active bots
 
+extern std::map<uint32, uint32>   gRetiredBots; // Bots players removed by a reload -> auctions they still own
+
+bool IsBot(uint32 playerId); // Active or retired bot
+
+extern uint32                                gTickBudgetUs; // Time available to all the bots in a single update, zero for no limit
+extern std::chrono::steady_clock::time_point gTickStart;    // Beginning of the current update
+extern uint64                                gTicks;        // Updates since the startup
+
+bool IsTickBudgetExhausted();
+
+extern std::vector<uint32> gDisposedItems; // Items of the bots expired auctions, still to be deleted from the database
+
+void FlushDisposedItems(bool shutdown);
+
 #endif // AUCTION_HOUSE_BOT_COMMON_H
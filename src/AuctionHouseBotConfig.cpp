@@ -17,6 +17,10 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
 #include "AuctionHouseMgr.h"
 #include "Common.h"
 #include "Config.h"
@@ -26,11 +30,31 @@
 #include "Log.h"
 #include "ObjectMgr.h"
 #include "QueryResult.h"
+#include "StringFormat.h"
+#include "Timer.h"
 #include "WorldSession.h"
 
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotConfig.h"
 
+//
+// Bins already built, by hash of the filters and identity of the sources used to build them
+//
+
+static std::mutex                                      gBinsRegistryLock;
+static std::map<uint64, std::weak_ptr<AHBBins const>> gBinsRegistry;
+
+//
+// Presence of the table of the market prices, checked once at startup
+//
+
+static bool gMarketTableFound = false;
+
+static uint64 GetBinsKey(uint64 filtersHash, uint32 sourcesId)
+{
+    return (filtersHash ^ sourcesId) * 1099511628211ULL;
+}
+
 using namespace std;
 
 AHBConfig::AHBConfig()
@@ -99,20 +123,12 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
 
     minItems                       = conf->minItems;
     maxItems                       = conf->maxItems;
-    percentGreyTradeGoods          = conf->percentGreyTradeGoods;
-    percentWhiteTradeGoods         = conf->percentWhiteTradeGoods;
-    percentGreenTradeGoods         = conf->percentGreenTradeGoods;
-    percentBlueTradeGoods          = conf->percentBlueTradeGoods;
-    percentPurpleTradeGoods        = conf->percentPurpleTradeGoods;
-    percentOrangeTradeGoods        = conf->percentOrangeTradeGoods;
-    percentYellowTradeGoods        = conf->percentYellowTradeGoods;
-    percentGreyItems               = conf->percentGreyItems;
-    percentWhiteItems              = conf->percentWhiteItems;
-    percentGreenItems              = conf->percentGreenItems;
-    percentBlueItems               = conf->percentBlueItems;
-    percentPurpleItems             = conf->percentPurpleItems;
-    percentOrangeItems             = conf->percentOrangeItems;
-    percentYellowItems             = conf->percentYellowItems;
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        percentages[category]      = conf->percentages[category];
+    }
+
     minPriceGrey                   = conf->minPriceGrey;
     maxPriceGrey                   = conf->maxPriceGrey;
     minBidPriceGrey                = conf->minBidPriceGrey;
@@ -157,36 +173,9 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     buyerBiddingInterval           = conf->buyerBiddingInterval;
     buyerBidsPerInterval           = conf->buyerBidsPerInterval;
 
-    // This part is acquired thorugh initialization
-    //
-    // greytgp                        = conf->greytgp;
-    // whitetgp                       = conf->whitetgp;
-    // greentgp                       = conf->greentgp;
-    // bluetgp                        = conf->bluetgp;
-    // purpletgp                      = conf->purpletgp;
-    // orangetgp                      = conf->orangetgp;
-    // yellowtgp                      = conf->yellowtgp;
-    // greyip                         = conf->greyip;
-    // whiteip                        = conf->whiteip;
-    // greenip                        = conf->greenip;
-    // blueip                         = conf->blueip;
-    // purpleip                       = conf->purpleip;
-    // orangeip                       = conf->orangeip;
-    // yellowip                       = conf->yellowip;
-    // greyTGoods                     = conf->greyTGoods;
-    // whiteTGoods                    = conf->whiteTGoods;
-    // greenTGoods                    = conf->greenTGoods;
-    // blueTGoods                     = conf->blueTGoods;
-    // purpleTGoods                   = conf->purpleTGoods;
-    // orangeTGoods                   = conf->orangeTGoods;
-    // yellowTGoods                   = conf->yellowTGoods;
-    // greyItems                      = conf->greyItems;
-    // whiteItems                     = conf->whiteItems;
-    // greenItems                     = conf->greenItems;
-    // blueItems                      = conf->blueItems;
-    // purpleItems                    = conf->purpleItems;
-    // orangeItems                    = conf->orangeItems;
-    // yellowItems                    = conf->yellowItems;
+    //
+    // The maxima and the counts are acquired through initialization
+    //
 
     //
     // Copy the public properties
@@ -203,8 +192,13 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     AHBBuyer                       = conf->AHBBuyer;
     UseBuyPriceForBuyer            = conf->UseBuyPriceForBuyer;
     UseBuyPriceForSeller           = conf->UseBuyPriceForSeller;
+    UndercutCompetition            = conf->UndercutCompetition;
+    PreferSellingItems             = conf->PreferSellingItems;
+    ExpiryPerMinute                = conf->ExpiryPerMinute;
+    UndercutPercent                = conf->UndercutPercent;
     ConsiderOnlyBotAuctions        = conf->ConsiderOnlyBotAuctions;
     ItemsPerCycle                  = conf->ItemsPerCycle;
+    SellerBatchSize                = conf->SellerBatchSize;
     Vendor_Items                   = conf->Vendor_Items;
     Loot_Items                     = conf->Loot_Items;
     Other_Items                    = conf->Other_Items;
@@ -261,118 +255,15 @@ AHBConfig::AHBConfig(uint32 ahid, AHBConfig* conf)
     // Copy the sets
     //
 
-    NpcItems.clear();
-    for (uint32 id: conf->NpcItems)
-    {
-        NpcItems.insert(id);
-    }
-
-    LootItems.clear();
-    for (uint32 id: conf->LootItems)
-    {
-        LootItems.insert(id);
-    }
-
-    DisableItemStore.clear();
-    for (uint32 id: conf->DisableItemStore)
-    {
-        DisableItemStore.insert(id);
-    }
-
-    SellerWhiteList.clear();
-    for (uint32 id: conf->SellerWhiteList)
-    {
-        SellerWhiteList.insert(id);
-    }
-
-    GreyTradeGoodsBin.clear();
-    for (uint32 id: conf->GreyTradeGoodsBin)
-    {
-        GreyTradeGoodsBin.insert(id);
-    }
-
-    WhiteTradeGoodsBin.clear();
-    for (uint32 id: conf->WhiteTradeGoodsBin)
-    {
-        WhiteTradeGoodsBin.insert(id);
-    }
-
-    GreenTradeGoodsBin.clear();
-    for (uint32 id: conf->GreenTradeGoodsBin)
-    {
-        GreenTradeGoodsBin.insert(id);
-    }
-
-    BlueTradeGoodsBin.clear();
-    for (uint32 id: conf->BlueTradeGoodsBin)
-    {
-        BlueTradeGoodsBin.insert(id);
-    }
-
-    PurpleTradeGoodsBin.clear();
-    for (uint32 id: conf->PurpleTradeGoodsBin)
-    {
-        PurpleTradeGoodsBin.insert(id);
-    }
-
-    OrangeTradeGoodsBin.clear();
-    for (uint32 id: conf->OrangeTradeGoodsBin)
-    {
-        OrangeTradeGoodsBin.insert(id);
-    }
-
-    YellowTradeGoodsBin.clear();
-    for (uint32 id: conf->YellowTradeGoodsBin)
-    {
-        YellowTradeGoodsBin.insert(id);
-    }
+    Sources                        = conf->Sources;
 
+    SellerWhiteList                = conf->SellerWhiteList;
 
     //
-    // Bins for items
+    // Share the bins
     //
 
-    GreyItemsBin.clear();
-    for (uint32 id: conf->GreyItemsBin)
-    {
-        GreyItemsBin.insert(id);
-    }
-
-    WhiteItemsBin.clear();
-    for (uint32 id: conf->WhiteItemsBin)
-    {
-        WhiteItemsBin.insert(id);
-    }
-
-    GreenItemsBin.clear();
-    for (uint32 id: conf->GreenItemsBin)
-    {
-        GreenItemsBin.insert(id);
-    }
-
-    BlueItemsBin.clear();
-    for (uint32 id: conf->BlueItemsBin)
-    {
-        BlueItemsBin.insert(id);
-    }
-
-    PurpleItemsBin.clear();
-    for (uint32 id: conf->PurpleItemsBin)
-    {
-        PurpleItemsBin.insert(id);
-    }
-
-    OrangeItemsBin.clear();
-    for (uint32 id: conf->OrangeItemsBin)
-    {
-        OrangeItemsBin.insert(id);
-    }
-
-    YellowItemsBin.clear();
-    for (uint32 id: conf->YellowItemsBin)
-    {
-        YellowItemsBin.insert(id);
-    }
+    Bins                           = conf->Bins;
 }
 
 AHBConfig::~AHBConfig()
@@ -391,21 +282,15 @@ void AHBConfig::Reset()
     minItems                       = 0;
     maxItems                       = 0;
 
-    percentGreyTradeGoods          = 0;
-    percentWhiteTradeGoods         = 0;
-    percentGreenTradeGoods         = 0;
-    percentBlueTradeGoods          = 0;
-    percentPurpleTradeGoods        = 0;
-    percentOrangeTradeGoods        = 0;
-    percentYellowTradeGoods        = 0;
-
-    percentGreyItems               = 0;
-    percentWhiteItems              = 0;
-    percentGreenItems              = 0;
-    percentBlueItems               = 0;
-    percentPurpleItems             = 0;
-    percentOrangeItems             = 0;
-    percentYellowItems             = 0;
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        percentages[category]      = 0;
+        maxima[category]           = 0;
+        counts[category]           = 0;
+        listed[category]           = 0;
+        sold[category]             = 0;
+        expired[category]          = 0;
+    }
 
     minPriceGrey                   = 0;
     maxPriceGrey                   = 0;
@@ -460,38 +345,6 @@ void AHBConfig::Reset()
     buyerBiddingInterval           = 0;
     buyerBidsPerInterval           = 0;
 
-    greytgp                        = 0;
-    whitetgp                       = 0;
-    greentgp                       = 0;
-    bluetgp                        = 0;
-    purpletgp                      = 0;
-    orangetgp                      = 0;
-    yellowtgp                      = 0;
-
-    greyip                         = 0;
-    whiteip                        = 0;
-    greenip                        = 0;
-    blueip                         = 0;
-    purpleip                       = 0;
-    orangeip                       = 0;
-    yellowip                       = 0;
-
-    greyTGoods                     = 0;
-    whiteTGoods                    = 0;
-    greenTGoods                    = 0;
-    blueTGoods                     = 0;
-    purpleTGoods                   = 0;
-    orangeTGoods                   = 0;
-    yellowTGoods                   = 0;
-
-    greyItems                      = 0;
-    whiteItems                     = 0;
-    greenItems                     = 0;
-    blueItems                      = 0;
-    purpleItems                    = 0;
-    orangeItems                    = 0;
-    yellowItems                    = 0;
-
     //
     // Public properties
     //
@@ -511,8 +364,18 @@ void AHBConfig::Reset()
     UseBuyPriceForBuyer            = false;
     UseBuyPriceForSeller           = false;
     SellAtMarketPrice              = false;
+    MarketPriceHalfLife            = 86400;
+    MarketMaxItems                 = 0;
+    MarketSaveInterval             = 0;
+    MarketSaveUpdates              = 0;
+    MarketWarmStart                = false;
+    UndercutCompetition            = false;
+    PreferSellingItems             = false;
+    ExpiryPerMinute                = 0;
+    UndercutPercent                = 5;
     ConsiderOnlyBotAuctions        = false;
     ItemsPerCycle                  = 200;
+    SellerBatchSize                = 0;
 
     Vendor_Items                   = false;
     Loot_Items                     = true;
@@ -574,31 +437,21 @@ void AHBConfig::Reset()
     // Sets
     //
 
-    NpcItems.clear();
-    LootItems.clear();
+    Sources.reset();
+    SellerWhiteList.Clear();
+
+    Bins.reset();
 
-    DisableItemStore.clear();
-    SellerWhiteList.clear();
+    market.Clear();
+    marketSavedAt = time(NULL);
 
-    GreyTradeGoodsBin.clear();
-    WhiteTradeGoodsBin.clear();
-    GreenTradeGoodsBin.clear();
-    BlueTradeGoodsBin.clear();
-    PurpleTradeGoodsBin.clear();
-    OrangeTradeGoodsBin.clear();
-    YellowTradeGoodsBin.clear();
+    outcomes.Clear();
 
-    GreyItemsBin.clear();
-    WhiteItemsBin.clear();
-    GreenItemsBin.clear();
-    BlueItemsBin.clear();
-    PurpleItemsBin.clear();
-    OrangeItemsBin.clear();
-    YellowItemsBin.clear();
+    botAuctions.clear();
+    botItemAuctions.clear();
 
-    itemsCount.clear();
-    itemsSum.clear();
-    itemsPrice.clear();
+    buyerCandidates.clear();
+    buyerCursor                    = 0;
 }
 
 uint32 AHBConfig::GetAHID()
@@ -699,88 +552,32 @@ void AHBConfig::SetPercentages(
         yellowi  = 0;
     }
 
-    percentGreyTradeGoods   = greytg;
-    percentWhiteTradeGoods  = whitetg;
-    percentGreenTradeGoods  = greentg;
-    percentBlueTradeGoods   = bluetg;
-    percentPurpleTradeGoods = purpletg;
-    percentOrangeTradeGoods = orangetg;
-    percentYellowTradeGoods = yellowtg;
-    percentGreyItems        = greyi;
-    percentWhiteItems       = whitei;
-    percentGreenItems       = greeni;
-    percentBlueItems        = bluei;
-    percentPurpleItems      = purplei;
-    percentOrangeItems      = orangei;
-    percentYellowItems      = yellowi;
+    percentages[AHB_GREY_TG]   = greytg;
+    percentages[AHB_WHITE_TG]  = whitetg;
+    percentages[AHB_GREEN_TG]  = greentg;
+    percentages[AHB_BLUE_TG]   = bluetg;
+    percentages[AHB_PURPLE_TG] = purpletg;
+    percentages[AHB_ORANGE_TG] = orangetg;
+    percentages[AHB_YELLOW_TG] = yellowtg;
+    percentages[AHB_GREY_I]    = greyi;
+    percentages[AHB_WHITE_I]   = whitei;
+    percentages[AHB_GREEN_I]   = greeni;
+    percentages[AHB_BLUE_I]    = bluei;
+    percentages[AHB_PURPLE_I]  = purplei;
+    percentages[AHB_ORANGE_I]  = orangei;
+    percentages[AHB_YELLOW_I]  = yellowi;
 
     CalculatePercents();
 }
 
 uint32 AHBConfig::GetPercentages(uint32 color)
 {
-    switch (color)
+    if (color >= AHB_CATEGORIES)
     {
-    case AHB_GREY_TG:
-        return percentGreyTradeGoods;
-        break;
-
-    case AHB_WHITE_TG:
-        return percentWhiteTradeGoods;
-        break;
-
-    case AHB_GREEN_TG:
-        return percentGreenTradeGoods;
-        break;
-
-    case AHB_BLUE_TG:
-        return percentBlueTradeGoods;
-        break;
-
-    case AHB_PURPLE_TG:
-        return percentPurpleTradeGoods;
-        break;
-
-    case AHB_ORANGE_TG:
-        return percentOrangeTradeGoods;
-        break;
-
-    case AHB_YELLOW_TG:
-        return percentYellowTradeGoods;
-        break;
-
-    case AHB_GREY_I:
-        return percentGreyItems;
-        break;
-
-    case AHB_WHITE_I:
-        return percentWhiteItems;
-        break;
-
-    case AHB_GREEN_I:
-        return percentGreenItems;
-        break;
-
-    case AHB_BLUE_I:
-        return percentBlueItems;
-        break;
-
-    case AHB_PURPLE_I:
-        return percentPurpleItems;
-        break;
-
-    case AHB_ORANGE_I:
-        return percentOrangeItems;
-        break;
-
-    case AHB_YELLOW_I:
-        return percentYellowItems;
-        break;
-
-    default:
         return 0;
-        break;
     }
+
+    return percentages[color];
 }
 
 void AHBConfig::SetMinPrice(uint32 color, uint32 value)
@@ -1568,410 +1365,345 @@ void AHBConfig::CalculatePercents()
     // to be sold in the market
     //
 
-    greytgp   = (uint32)(((double)percentGreyTradeGoods / 100.0) * maxItems);
-    whitetgp  = (uint32)(((double)percentWhiteTradeGoods / 100.0) * maxItems);
-    greentgp  = (uint32)(((double)percentGreenTradeGoods / 100.0) * maxItems);
-    bluetgp   = (uint32)(((double)percentBlueTradeGoods / 100.0) * maxItems);
-    purpletgp = (uint32)(((double)percentPurpleTradeGoods / 100.0) * maxItems);
-    orangetgp = (uint32)(((double)percentOrangeTradeGoods / 100.0) * maxItems);
-    yellowtgp = (uint32)(((double)percentYellowTradeGoods / 100.0) * maxItems);
-
-    greyip    = (uint32)(((double)percentGreyItems / 100.0) * maxItems);
-    whiteip   = (uint32)(((double)percentWhiteItems / 100.0) * maxItems);
-    greenip   = (uint32)(((double)percentGreenItems / 100.0) * maxItems);
-    blueip    = (uint32)(((double)percentBlueItems / 100.0) * maxItems);
-    purpleip  = (uint32)(((double)percentPurpleItems / 100.0) * maxItems);
-    orangeip  = (uint32)(((double)percentOrangeItems / 100.0) * maxItems);
-    yellowip  = (uint32)(((double)percentYellowItems / 100.0) * maxItems);
-
-    uint32 total =
-        greytgp +
-        whitetgp +
-        greentgp +
-        bluetgp +
-        purpletgp +
-        orangetgp +
-        yellowtgp +
-        greyip +
-        whiteip +
-        greenip +
-        blueip +
-        purpleip +
-        orangeip +
-        yellowip;
+    uint32 total = 0;
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        maxima[category] = (uint32)(((double)percentages[category] / 100.0) * maxItems);
+        total           += maxima[category];
+    }
 
     int32 diff = (maxItems - total);
 
     if (diff < 0)
     {
-        if ((whiteip - diff) > 0)
+        if ((maxima[AHB_WHITE_I] - diff) > 0)
         {
-            whiteip -= diff;
+            maxima[AHB_WHITE_I] -= diff;
         }
-        else if ((greenip - diff) > 0)
+        else if ((maxima[AHB_GREEN_I] - diff) > 0)
         {
-            greenip -= diff;
+            maxima[AHB_GREEN_I] -= diff;
         }
     }
 }
 
 uint32 AHBConfig::GetMaximum(uint32 ahbotItemType)
 {
-    switch (ahbotItemType)
+    if (ahbotItemType >= AHB_CATEGORIES)
     {
-    case AHB_GREY_TG:
-        return greytgp;
-
-    case AHB_WHITE_TG:
-        return whitetgp;
-
-    case AHB_GREEN_TG:
-        return greentgp;
-
-    case AHB_BLUE_TG:
-        return bluetgp;
+        LOG_ERROR("module", "AHBot AHBConfig::GetMaximum() invalid param");
+        return 0;
+    }
 
-    case AHB_PURPLE_TG:
-        return purpletgp;
+    return maxima[ahbotItemType];
+}
 
-    case AHB_ORANGE_TG:
-        return orangetgp;
+uint32 AHBConfig::GetDeficits(uint32* deficits)
+{
+    //
+    // How many auctions each category misses to reach its maximum, in a single pass over the tables
+    //
 
-    case AHB_YELLOW_TG:
-        return yellowtgp;
+    uint32 total = 0;
 
-    case AHB_GREY_I:
-        return greyip;
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        deficits[category] = counts[category] < maxima[category] ? maxima[category] - counts[category] : 0;
+        total             += deficits[category];
+    }
 
-    case AHB_WHITE_I:
-        return whiteip;
+    return total;
+}
 
-    case AHB_GREEN_I:
-        return greenip;
+std::vector<uint32> const& AHBConfig::GetBin(uint32 ahbotItemType)
+{
+    static std::vector<uint32> const emptyBin;
 
-    case AHB_BLUE_I:
-        return blueip;
+    if (!Bins)
+    {
+        return emptyBin;
+    }
 
-    case AHB_PURPLE_I:
-        return purpleip;
+    if (ahbotItemType >= AHB_CATEGORIES)
+    {
+        LOG_ERROR("module", "AHBot AHBConfig::GetBin() invalid param");
+        return emptyBin;
+    }
 
-    case AHB_ORANGE_I:
-        return orangeip;
+    return Bins->Bin[ahbotItemType];
+}
 
-    case AHB_YELLOW_I:
-        return yellowip;
+void AHBConfig::DecItemCounts(uint32 Class, uint32 Quality)
+{
+    DecItemCounts(GetItemCategory(Class, Quality));
+}
 
-    default:
+void AHBConfig::DecItemCounts(uint32 ahbotItemType)
+{
+    if (ahbotItemType < AHB_CATEGORIES && counts[ahbotItemType] > 0)
     {
-        LOG_ERROR("module", "AHBot AHBConfig::GetMaximum() invalid param");
-        return 0;
-    }
+        --counts[ahbotItemType];
     }
 }
 
-void AHBConfig::DecItemCounts(uint32 Class, uint32 Quality)
+void AHBConfig::IncItemCounts(uint32 Class, uint32 Quality)
 {
-    switch (Class)
-    {
-    case ITEM_CLASS_TRADE_GOODS:
-        DecItemCounts(Quality);
-        break;
+    IncItemCounts(GetItemCategory(Class, Quality));
+}
 
-    default:
-        DecItemCounts(Quality + AHB_ITEM_TYPE_OFFSET);
-        break;
+void AHBConfig::IncItemCounts(uint32 ahbotItemType)
+{
+    if (ahbotItemType < AHB_CATEGORIES)
+    {
+        ++counts[ahbotItemType];
     }
 }
 
-void AHBConfig::DecItemCounts(uint32 ahbotItemType)
+void AHBConfig::ResetItemCounts()
 {
-    switch (ahbotItemType)
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
     {
-    case AHB_GREY_TG:
-        if (greyTGoods > 0)
-        {
-            --greyTGoods;
-        }
-        break;
+        counts[category] = 0;
+    }
+}
 
-    case AHB_WHITE_TG:
-        if (whiteTGoods > 0)
-        {
-            --whiteTGoods;
-        }
-        break;
+uint32 AHBConfig::TotalItemCounts()
+{
+    uint32 total = 0;
 
-    case AHB_GREEN_TG:        
-        if (greenTGoods > 0)
-        {
-            --greenTGoods;
-        }
-        break;
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        total += counts[category];
+    }
 
-    case AHB_BLUE_TG:
-        if (blueTGoods > 0)
-        {
-            --blueTGoods;
-        }
-        break;
+    return total;
+}
 
-    case AHB_PURPLE_TG:
-        if (purpleTGoods > 0)
-        {
-            --purpleTGoods;
-        }
-        break;
+uint32 AHBConfig::GetItemCounts(uint32 color)
+{
+    if (color >= AHB_CATEGORIES)
+    {
+        return 0;
+    }
 
-    case AHB_ORANGE_TG:
-        if (orangeTGoods > 0)
-        {
-            --orangeTGoods;        
-        }
-        break;
+    return counts[color];
+}
 
-    case AHB_YELLOW_TG:
-        if (yellowTGoods > 0)
-        {
-            --yellowTGoods;
-        }
-        break;
+void AHBConfig::IncBotAuctions(uint32 botId, uint32 itemId)
+{
+    ++botAuctions[botId];
+    ++botItemAuctions[(uint64(botId) << 32) | itemId];
+}
 
-    case AHB_GREY_I:
-        if (greyItems > 0)
-        {
-            --greyItems;
-        }
-        break;
+void AHBConfig::DecBotAuctions(uint32 botId, uint32 itemId)
+{
+    auto it = botAuctions.find(botId);
 
-    case AHB_WHITE_I:
-        if (whiteItems > 0)
-        {
-            --whiteItems;
-        }
-        break;
+    if (it != botAuctions.end() && it->second > 0)
+    {
+        --it->second;
+    }
 
-    case AHB_GREEN_I:
-        if (greenItems > 0)
-        {
-            --greenItems;
-        }
-        break;
+    auto itItem = botItemAuctions.find((uint64(botId) << 32) | itemId);
 
-    case AHB_BLUE_I:
-        if (blueItems > 0)
+    if (itItem != botItemAuctions.end())
+    {
+        if (itItem->second > 1)
         {
-            --blueItems;
+            --itItem->second;
         }
-        break;
-
-    case AHB_PURPLE_I:
-        if (purpleItems > 0)
+        else
         {
-            --purpleItems;
+            botItemAuctions.erase(itItem);
         }
-        break;
+    }
+}
 
-    case AHB_ORANGE_I:
-        if (orangeItems > 0)
-        {
-            --orangeItems;
-        }
-        break;
+void AHBConfig::ResetBotAuctions()
+{
+    botAuctions.clear();
+    botItemAuctions.clear();
+}
 
-    case AHB_YELLOW_I:
-        if (yellowItems > 0)
-        {
-            --yellowItems;
-        }
-        break;
+uint32 AHBConfig::GetBotAuctions(uint32 botId)
+{
+    auto it = botAuctions.find(botId);
 
-    default:
-        break;
+    if (it != botAuctions.end())
+    {
+        return it->second;
     }
+
+    return 0;
 }
 
-void AHBConfig::IncItemCounts(uint32 Class, uint32 Quality)
+uint32 AHBConfig::GetBotItemAuctions(uint32 botId, uint32 itemId)
 {
-    switch (Class)
-    {
-    case ITEM_CLASS_TRADE_GOODS:
-        IncItemCounts(Quality);
-        break;
+    auto it = botItemAuctions.find((uint64(botId) << 32) | itemId);
 
-    default:
-        IncItemCounts(Quality + 7);
-        break;
+    if (it != botItemAuctions.end())
+    {
+        return it->second;
     }
+
+    return 0;
 }
 
-void AHBConfig::IncItemCounts(uint32 ahbotItemType)
+void AHBConfig::AddBuyerCandidate(uint32 auctionId)
 {
-    switch (ahbotItemType)
-    {
-    case AHB_GREY_TG:
-        ++greyTGoods;
-        break;
-
-    case AHB_WHITE_TG:
-        ++whiteTGoods;
-        break;
+    buyerCandidates.insert(auctionId);
+}
 
-    case AHB_GREEN_TG:
-        ++greenTGoods;
-        break;
+void AHBConfig::RemoveBuyerCandidate(uint32 auctionId)
+{
+    buyerCandidates.erase(auctionId);
+}
 
-    case AHB_BLUE_TG:
-        ++blueTGoods;
-        break;
+void AHBConfig::ResetBuyerCandidates()
+{
+    buyerCandidates.clear();
+    buyerCursor = 0;
+}
 
-    case AHB_PURPLE_TG:
-        ++purpleTGoods;
-        break;
+uint32 AHBConfig::GetBuyerCandidates()
+{
+    return buyerCandidates.size();
+}
 
-    case AHB_ORANGE_TG:
-        ++orangeTGoods;
-        break;
+uint32 AHBConfig::NextBuyerCandidate()
+{
+    //
+    // Walk the candidates in a round robin way, so that every auction gets its chance over the intervals
+    //
 
-    case AHB_YELLOW_TG:
-        ++yellowTGoods;
-        break;
+    std::set<uint32>::iterator it = buyerCandidates.upper_bound(buyerCursor);
 
-    case AHB_GREY_I:
-        ++greyItems;
-        break;
+    if (it == buyerCandidates.end())
+    {
+        it = buyerCandidates.begin();
+    }
 
-    case AHB_WHITE_I:
-        ++whiteItems;
-        break;
+    if (it == buyerCandidates.end())
+    {
+        return 0;
+    }
 
-    case AHB_GREEN_I:
-        ++greenItems;
-        break;
+    buyerCursor = *it;
 
-    case AHB_BLUE_I:
-        ++blueItems;
-        break;
+    return buyerCursor;
+}
 
-    case AHB_PURPLE_I:
-        ++purpleItems;
-        break;
+void AHBConfig::AddListing(uint32 itemId, uint32 stackSize, uint64 buyout)
+{
+    //
+    // Auctions without a buyout do not set a price anyone can buy at
+    //
 
-    case AHB_ORANGE_I:
-        ++orangeItems;
-        break;
-
-    case AHB_YELLOW_I:
-        ++yellowItems;
-        break;
-
-    default:
-        break;
+    if (buyout == 0)
+    {
+        return;
     }
+
+    listings[itemId].insert(buyout / std::max<uint32>(stackSize, 1));
 }
 
-void AHBConfig::ResetItemCounts()
+void AHBConfig::RemoveListing(uint32 itemId, uint32 stackSize, uint64 buyout)
 {
-    greyTGoods   = 0;
-    whiteTGoods  = 0;
-    greenTGoods  = 0;
-    blueTGoods   = 0;
-    purpleTGoods = 0;
-    orangeTGoods = 0;
-    yellowTGoods = 0;
+    if (buyout == 0)
+    {
+        return;
+    }
 
-    greyItems    = 0;
-    whiteItems   = 0;
-    greenItems   = 0;
-    blueItems    = 0;
-    purpleItems  = 0;
-    orangeItems  = 0;
-    yellowItems  = 0;
-}
+    std::unordered_map<uint32, std::multiset<uint64>>::iterator it = listings.find(itemId);
 
-uint32 AHBConfig::TotalItemCounts()
-{
-    return(
-        greyTGoods +
-        whiteTGoods +
-        greenTGoods +
-        blueTGoods +
-        purpleTGoods +
-        orangeTGoods +
-        yellowTGoods +
+    if (it == listings.end())
+    {
+        return;
+    }
 
-        greyItems +
-        whiteItems +
-        greenItems +
-        blueItems +
-        purpleItems +
-        orangeItems +
-        yellowItems);
-}
+    std::multiset<uint64>::iterator price = it->second.find(buyout / std::max<uint32>(stackSize, 1));
 
-uint32 AHBConfig::GetItemCounts(uint32 color)
-{
-    switch (color)
+    if (price != it->second.end())
     {
-    case AHB_GREY_TG:
-        return greyTGoods;
-        break;
+        it->second.erase(price);
+    }
 
-    case AHB_WHITE_TG:
-        return whiteTGoods;
-        break;
+    if (it->second.empty())
+    {
+        listings.erase(it);
+    }
+}
 
-    case AHB_GREEN_TG:
-        return greenTGoods;
-        break;
+void AHBConfig::ResetListings()
+{
+    listings.clear();
+}
 
-    case AHB_BLUE_TG:
-        return blueTGoods;
-        break;
+uint64 AHBConfig::GetLowestListing(uint32 itemId)
+{
+    std::unordered_map<uint32, std::multiset<uint64>>::const_iterator it = listings.find(itemId);
 
-    case AHB_PURPLE_TG:
-        return purpleTGoods;
-        break;
+    if (it == listings.end())
+    {
+        return 0;
+    }
 
-    case AHB_ORANGE_TG:
-        return orangeTGoods;
-        break;
+    return *it->second.begin();
+}
 
-    case AHB_YELLOW_TG:
-        return yellowTGoods;
-        break;
+uint32 AHBConfig::GetListings(uint32 itemId)
+{
+    std::unordered_map<uint32, std::multiset<uint64>>::const_iterator it = listings.find(itemId);
 
-    case AHB_GREY_I:
-        return greyItems;
-        break;
+    if (it == listings.end())
+    {
+        return 0;
+    }
 
-    case AHB_WHITE_I:
-        return whiteItems;
-        break;
+    return uint32(it->second.size());
+}
 
-    case AHB_GREEN_I:
-        return greenItems;
-        break;
+void AHBConfig::AddExpiry(time_t expireTime)
+{
+    ++expiries[uint32(expireTime / MINUTE)];
+}
 
-    case AHB_BLUE_I:
-        return blueItems;
-        break;
+void AHBConfig::RemoveExpiry(time_t expireTime)
+{
+    std::map<uint32, uint32>::iterator it = expiries.find(uint32(expireTime / MINUTE));
 
-    case AHB_PURPLE_I:
-        return purpleItems;
-        break;
+    if (it == expiries.end())
+    {
+        return;
+    }
 
-    case AHB_ORANGE_I:
-        return orangeItems;
-        break;
+    if (--it->second == 0)
+    {
+        expiries.erase(it);
+    }
+}
 
-    case AHB_YELLOW_I:
-        return yellowItems;
-        break;
+void AHBConfig::ResetExpiries()
+{
+    expiries.clear();
+}
 
-    default:
+uint32 AHBConfig::GetExpiries(time_t expireTime)
+{
+    std::map<uint32, uint32>::const_iterator it = expiries.find(uint32(expireTime / MINUTE));
+
+    if (it == expiries.end())
+    {
         return 0;
-        break;
     }
+
+    return it->second;
+}
+
+std::map<uint32, uint32> const& AHBConfig::GetExpiryDistribution()
+{
+    return expiries;
 }
 
 void AHBConfig::SetBidsPerInterval(uint32 value)
@@ -1986,7 +1718,12 @@ uint32 AHBConfig::GetBidsPerInterval()
 
 void AHBConfig::UpdateItemStats(uint32 id, uint32 stackSize, uint64 buyout)
 {
-    if (!stackSize)
+    //
+    // A zero price is no sample: an auction expired without bids, or sold without a buyout, tells nothing
+    // about the price, and would drag the average toward zero
+    //
+
+    if (!stackSize || !buyout)
     {
         return;
     }
@@ -1995,62 +1732,316 @@ void AHBConfig::UpdateItemStats(uint32 id, uint32 stackSize, uint64 buyout)
     // Collects information about the item bought
     //
 
-    uint32 perUnit = buyout / stackSize;
+    uint32          perUnit = buyout / stackSize;
+    uint32          now     = uint32(time(NULL));
+    AHBMarketEntry& entry   = market.Update(id);
 
-    if (itemsCount.count(id) == 0)
+    //
+    // The price is an exponentially time weighted average of the per unit prices: the weight of
+    // the past samples halves every MarketPriceHalfLife seconds, so the price follows the market
+    // smoothly and the state of an item is constant in size.
+    //
+
+    if (entry.Weight > 0 && now > entry.Time)
     {
-        itemsCount[id] = 1;
-        itemsSum[id]   = perUnit;
-        itemsPrice[id] = perUnit;
+        double decay = MarketPriceHalfLife > 0 ? std::exp2(-double(now - entry.Time) / double(MarketPriceHalfLife)) : 0.0;
+
+        entry.Sum    *= decay;
+        entry.Weight *= decay;
     }
-    else
+
+    entry.Sum    += perUnit;
+    entry.Weight += 1.0;
+    entry.Time    = now;
+    entry.Price   = uint64(entry.Sum / entry.Weight + 0.5);
+
+    if (IsMarketSaved())
     {
-        itemsCount[id]++;
+        market.MarkDirty(entry);
+    }
 
-        //
-        // Reset the statistics to force adapt to the market price.
-        // Adds a little of randomness by adding/removing a range of 9 to the threshold.
-        //
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Updating market price item={}, price={}", id, entry.Price);
+    }
+}
+
+void AHBConfig::SeedItemStats(uint32 id, uint32 stackSize, uint64 buyout)
+{
+    if (!stackSize || !buyout)
+    {
+        return;
+    }
+
+    //
+    // A listed buyout is only an asked price, weaker evidence than a sold or expired auction:
+    // it enters the average with a fraction of the weight, so the real trades take over quickly.
+    //
+
+    static double const seedWeight = 0.25;
+
+    uint32          perUnit = buyout / stackSize;
+    AHBMarketEntry& entry   = market.Update(id);
+
+    entry.Sum    += perUnit * seedWeight;
+    entry.Weight += seedWeight;
+    entry.Time    = uint32(time(NULL));
+    entry.Price   = uint64(entry.Sum / entry.Weight + 0.5);
+}
 
-        if (itemsCount[id] > MarketResetThreshold + (urand(1, 19) - 10))
+uint64 AHBConfig::GetItemPrice(uint32 id)
+{
+    AHBMarketEntry const* entry = market.Find(id);
+
+    if (entry)
+    {
+        return entry->Price;
+    }
+
+    return 0;
+}
+
+void AHBConfig::CarryOverMarket(AHBConfig* previous)
+{
+    //
+    // The market statistics are learned over time and do not depend on the settings, so a reload keeps them
+    //
+
+    market        = std::move(previous->market);
+    marketSavedAt = previous->marketSavedAt;
+    outcomes      = std::move(previous->outcomes);
+
+    market.SetLimit(MarketMaxItems);
+    outcomes.SetLimit(MarketMaxItems);
+
+    for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+    {
+        listed[category]  = previous->listed[category];
+        sold[category]    = previous->sold[category];
+        expired[category] = previous->expired[category];
+    }
+}
+
+void AHBConfig::IncListed(uint32 ahbotItemType)
+{
+    if (ahbotItemType < AHB_CATEGORIES)
+    {
+        listed[ahbotItemType]++;
+    }
+}
+
+void AHBConfig::UpdateSellThrough(uint32 id, bool success)
+{
+    ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(id);
+
+    if (!prototype)
+    {
+        return;
+    }
+
+    uint32 category = GetItemCategory(prototype->Class, prototype->Quality);
+
+    if (category < AHB_CATEGORIES)
+    {
+        if (success)
         {
-            itemsCount[id] = 1;
-            itemsSum[id]   = perUnit;
-            itemsPrice[id] = perUnit;
+            sold[category]++;
         }
         else
         {
-            //
-            // Here is decided the price for single unit:
-            // right now is a plain, boring average of the ~100 previous auctions.
-            //
-
-            itemsSum[id]   = (itemsSum[id] + perUnit);
-            itemsPrice[id] = itemsSum[id] / itemsCount[id];
+            expired[category]++;
         }
     }
 
-    if (DebugOutConfig)
+    //
+    // The outcomes of the single items are kept apart from their prices, bounded by the same limit
+    //
+
+    AHBMarketEntry& entry = outcomes.Update(id);
+
+    if (success)
+    {
+        entry.Sold++;
+    }
+    else
     {
-        LOG_INFO("module", "Updating market price item={}, price={}", id, itemsPrice[id]);
+        entry.Expired++;
     }
 }
 
-uint64 AHBConfig::GetItemPrice(uint32 id)
+double AHBConfig::GetSellThrough(uint32 id)
 {
-    if (itemsCount.count(id) != 0)
+    AHBMarketEntry const* entry = outcomes.Find(id);
+
+    if (!entry)
     {
-        return itemsPrice[id];
+        return 0.5;
     }
 
-    return 0;
+    return (entry->Sold + 1.0) / (entry->Sold + entry->Expired + 2.0);
+}
+
+uint32 AHBConfig::GetListed(uint32 ahbotItemType)
+{
+    if (ahbotItemType >= AHB_CATEGORIES)
+    {
+        return 0;
+    }
+
+    return listed[ahbotItemType];
 }
 
-void AHBConfig::Initialize(std::set<uint32> botsIds)
+uint32 AHBConfig::GetSold(uint32 ahbotItemType)
 {
-    InitializeFromFile();
-    InitializeFromSql(botsIds);
-    InitializeBins();
+    if (ahbotItemType >= AHB_CATEGORIES)
+    {
+        return 0;
+    }
+
+    return sold[ahbotItemType];
+}
+
+uint32 AHBConfig::GetExpired(uint32 ahbotItemType)
+{
+    if (ahbotItemType >= AHB_CATEGORIES)
+    {
+        return 0;
+    }
+
+    return expired[ahbotItemType];
+}
+
+bool AHBConfig::IsMarketSaved()
+{
+    return MarketSaveInterval > 0 && gMarketTableFound;
+}
+
+void AHBConfig::SaveMarket(bool shutdown)
+{
+    //
+    // The changed prices are written behind, in batches: when enough items changed or enough time
+    // passed. The transaction is committed asynchronously, except at shutdown.
+    //
+
+    if (!IsMarketSaved() || market.GetDirtyCount() == 0)
+    {
+        return;
+    }
+
+    time_t now = time(NULL);
+    bool   due = shutdown || now - marketSavedAt >= time_t(MarketSaveInterval);
+
+    if (MarketSaveUpdates > 0 && market.GetDirtyCount() >= MarketSaveUpdates)
+    {
+        due = true;
+    }
+
+    if (!due)
+    {
+        return;
+    }
+
+    marketSavedAt = now;
+
+    std::vector<AHBMarketEntry> entries = market.TakeDirty();
+
+    if (entries.empty())
+    {
+        return;
+    }
+
+    CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+
+    for (size_t first = 0; first < entries.size(); first += 256)
+    {
+        std::string query = "REPLACE INTO mod_auctionhousebot_market (auctionhouse, item, time, sum, weight, price) VALUES ";
+
+        for (size_t i = first; i < entries.size() && i < first + 256; i++)
+        {
+            if (i > first)
+            {
+                query += ", ";
+            }
+
+            query += Acore::StringFormat("({}, {}, {}, {}, {}, {})", AHID, entries[i].ItemId, entries[i].Time, entries[i].Sum, entries[i].Weight, entries[i].Price);
+        }
+
+        trans->Append(query);
+    }
+
+    if (shutdown)
+    {
+        CharacterDatabase.DirectCommitTransaction(trans);
+    }
+    else
+    {
+        CharacterDatabase.CommitTransaction(trans);
+    }
+
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "AHBot: saved {} market prices for ah {}", uint32(entries.size()), AHID);
+    }
+}
+
+void AHBConfig::LoadMarkets(std::vector<AHBConfig*> const& configs)
+{
+    //
+    // Load the prices of all the auction houses with a single query; the oldest come first, so
+    // that they are the first evicted if there are more than allowed.
+    //
+
+    QueryResult table = CharacterDatabase.Query("SELECT 1 FROM information_schema.tables WHERE table_schema = DATABASE() AND table_name = 'mod_auctionhousebot_market'");
+
+    gMarketTableFound = bool(table);
+
+    if (!gMarketTableFound)
+    {
+        for (AHBConfig* config : configs)
+        {
+            if (config->MarketSaveInterval > 0)
+            {
+                LOG_ERROR("module", "AHBot: table mod_auctionhousebot_market is missing from the characters database, the market prices will not be saved");
+                break;
+            }
+        }
+
+        return;
+    }
+
+    QueryResult result = CharacterDatabase.Query("SELECT auctionhouse, item, time, sum, weight, price FROM mod_auctionhousebot_market ORDER BY time");
+
+    if (!result)
+    {
+        return;
+    }
+
+    uint32 loaded = 0;
+
+    do
+    {
+        Field* fields = result->Fetch();
+        uint32 ahid   = fields[0].Get<uint32>();
+
+        for (AHBConfig* config : configs)
+        {
+            if (config->AHID != ahid || !config->IsMarketSaved())
+            {
+                continue;
+            }
+
+            AHBMarketEntry& entry = config->market.Update(fields[1].Get<uint32>());
+
+            entry.Time   = fields[2].Get<uint32>();
+            entry.Sum    = fields[3].Get<double>();
+            entry.Weight = fields[4].Get<double>();
+            entry.Price  = fields[5].Get<uint64>();
+
+            loaded++;
+        }
+    } while (result->NextRow());
+
+    LOG_INFO("module", "AHBot: loaded {} market prices", loaded);
 }
 
 void AHBConfig::InitializeFromFile()
@@ -2073,12 +2064,24 @@ void AHBConfig::InitializeFromFile()
     UseBuyPriceForSeller           = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForSeller"   , false);
     UseBuyPriceForBuyer            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseBuyPriceForBuyer"    , false);
     SellAtMarketPrice              = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UseMarketPriceForSeller", false);
-    MarketResetThreshold           = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketResetThreshold"   , 25);
+    MarketPriceHalfLife            = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketPriceHalfLife"    , 86400);
+    MarketMaxItems                 = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketMaxItems"         , 0);
+    MarketSaveInterval             = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketSaveInterval"     , 0);
+    MarketSaveUpdates              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.MarketSaveUpdates"      , 500);
+    MarketWarmStart                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.MarketWarmStart"        , false);
+    UndercutCompetition            = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.UndercutCompetition"    , false);
+    UndercutPercent                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.UndercutPercent"        , 5);
+    PreferSellingItems             = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.PreferSellingItems"     , false);
+    ExpiryPerMinute                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ExpiryPerMinute"        , 0);
     DuplicatesCount                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.DuplicatesCount"        , 0);
     DivisibleStacks                = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DivisibleStacks"        , false);
     ElapsingTimeClass              = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ElapsingTimeClass"      , 1);
     ConsiderOnlyBotAuctions        = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.ConsiderOnlyBotAuctions", false);
     ItemsPerCycle                  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.ItemsPerCycle"          , 200);
+    SellerBatchSize                = sConfigMgr->GetOption<uint32>("AuctionHouseBot.SellerBatchSize"        , 0);
+
+    market.SetLimit(MarketMaxItems);
+    outcomes.SetLimit(MarketMaxItems);
 
     //
     // Flags: item types
@@ -2161,37 +2164,90 @@ void AHBConfig::InitializeFromFile()
     // Whitelists
     //
 
-    SellerWhiteList                = getCommaSeparatedIntegers(sConfigMgr->GetOption<std::string>("AuctionHouseBot.SellerWhiteList", ""));
+    SellerWhiteList.Clear();
+
+    for (uint32 id : getCommaSeparatedIntegers(sConfigMgr->GetOption<std::string>("AuctionHouseBot.SellerWhiteList", "")))
+    {
+        SellerWhiteList.Insert(id);
+    }
+}
+
+void AHBConfig::LoadSettings(std::vector<AHBConfig*> const& configs)
+{
+    //
+    // Load the settings of all the auction houses at once: one row per auction house
+    //
+
+    QueryResult result = WorldDatabase.Query(
+        "SELECT auctionhouse, minitems, maxitems, "
+        "percentgreytradegoods, percentwhitetradegoods, percentgreentradegoods, percentbluetradegoods, percentpurpletradegoods, percentorangetradegoods, percentyellowtradegoods, "
+        "percentgreyitems, percentwhiteitems, percentgreenitems, percentblueitems, percentpurpleitems, percentorangeitems, percentyellowitems, "
+        "minpricegrey, maxpricegrey, minpricewhite, maxpricewhite, minpricegreen, maxpricegreen, minpriceblue, maxpriceblue, "
+        "minpricepurple, maxpricepurple, minpriceorange, maxpriceorange, minpriceyellow, maxpriceyellow, "
+        "minbidpricegrey, maxbidpricegrey, minbidpricewhite, maxbidpricewhite, minbidpricegreen, maxbidpricegreen, minbidpriceblue, maxbidpriceblue, "
+        "minbidpricepurple, maxbidpricepurple, minbidpriceorange, maxbidpriceorange, minbidpriceyellow, maxbidpriceyellow, "
+        "maxstackgrey, maxstackwhite, maxstackgreen, maxstackblue, maxstackpurple, maxstackorange, maxstackyellow, "
+        "buyerpricegrey, buyerpricewhite, buyerpricegreen, buyerpriceblue, buyerpricepurple, buyerpriceorange, buyerpriceyellow, "
+        "buyerbiddinginterval, buyerbidsperinterval "
+        "FROM mod_auctionhousebot");
+
+    std::set<uint32> loaded;
+
+    if (result)
+    {
+        do
+        {
+            Field* fields = result->Fetch();
+            uint32 ahid   = fields[0].Get<uint32>();
+
+            for (AHBConfig* config : configs)
+            {
+                if (config->GetAHID() == ahid)
+                {
+                    config->LoadSettings(fields);
+                    loaded.insert(ahid);
+                }
+            }
+        } while (result->NextRow());
+    }
+
+    for (AHBConfig* config : configs)
+    {
+        if (loaded.find(config->GetAHID()) == loaded.end())
+        {
+            LOG_ERROR("module", "AHBot: no settings found in mod_auctionhousebot for auction house {}", config->GetAHID());
+        }
+    }
 }
 
-void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
+void AHBConfig::LoadSettings(Field* fields)
 {
     //
     // Load min and max items
     //
 
-    SetMinItems(WorldDatabase.Query("SELECT minitems FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxItems(WorldDatabase.Query("SELECT maxitems FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    SetMinItems(fields[1].Get<uint32>());
+    SetMaxItems(fields[2].Get<uint32>());
 
     //
     // Load percentages
     //
 
-    uint32 greytg   = WorldDatabase.Query("SELECT percentgreytradegoods   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 whitetg  = WorldDatabase.Query("SELECT percentwhitetradegoods  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 greentg  = WorldDatabase.Query("SELECT percentgreentradegoods  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 bluetg   = WorldDatabase.Query("SELECT percentbluetradegoods   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 purpletg = WorldDatabase.Query("SELECT percentpurpletradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 orangetg = WorldDatabase.Query("SELECT percentorangetradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 yellowtg = WorldDatabase.Query("SELECT percentyellowtradegoods FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-
-    uint32 greyi    = WorldDatabase.Query("SELECT percentgreyitems        FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 whitei   = WorldDatabase.Query("SELECT percentwhiteitems       FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 greeni   = WorldDatabase.Query("SELECT percentgreenitems       FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 bluei    = WorldDatabase.Query("SELECT percentblueitems        FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 purplei  = WorldDatabase.Query("SELECT percentpurpleitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 orangei  = WorldDatabase.Query("SELECT percentorangeitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
-    uint32 yellowi  = WorldDatabase.Query("SELECT percentyellowitems      FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>();
+    uint32 greytg   = fields[3].Get<uint32>();
+    uint32 whitetg  = fields[4].Get<uint32>();
+    uint32 greentg  = fields[5].Get<uint32>();
+    uint32 bluetg   = fields[6].Get<uint32>();
+    uint32 purpletg = fields[7].Get<uint32>();
+    uint32 orangetg = fields[8].Get<uint32>();
+    uint32 yellowtg = fields[9].Get<uint32>();
+
+    uint32 greyi    = fields[10].Get<uint32>();
+    uint32 whitei   = fields[11].Get<uint32>();
+    uint32 greeni   = fields[12].Get<uint32>();
+    uint32 bluei    = fields[13].Get<uint32>();
+    uint32 purplei  = fields[14].Get<uint32>();
+    uint32 orangei  = fields[15].Get<uint32>();
+    uint32 yellowi  = fields[16].Get<uint32>();
 
     SetPercentages(greytg, whitetg, greentg, bluetg, purpletg, orangetg, yellowtg, greyi, whitei, greeni, bluei, purplei, orangei, yellowi);
 
@@ -2199,51 +2255,51 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
     // Load min and max prices
     // 
 
-    SetMinPrice(AHB_GREY  , WorldDatabase.Query("SELECT minpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_GREY  , WorldDatabase.Query("SELECT maxpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_WHITE , WorldDatabase.Query("SELECT minpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_WHITE , WorldDatabase.Query("SELECT maxpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_GREEN , WorldDatabase.Query("SELECT minpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_GREEN , WorldDatabase.Query("SELECT maxpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_BLUE  , WorldDatabase.Query("SELECT minpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_BLUE  , WorldDatabase.Query("SELECT maxpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_PURPLE, WorldDatabase.Query("SELECT minpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_PURPLE, WorldDatabase.Query("SELECT maxpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_ORANGE, WorldDatabase.Query("SELECT minpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_ORANGE, WorldDatabase.Query("SELECT maxpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinPrice(AHB_YELLOW, WorldDatabase.Query("SELECT minpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxPrice(AHB_YELLOW, WorldDatabase.Query("SELECT maxpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    SetMinPrice(AHB_GREY  , fields[17].Get<uint32>());
+    SetMaxPrice(AHB_GREY  , fields[18].Get<uint32>());
+    SetMinPrice(AHB_WHITE , fields[19].Get<uint32>());
+    SetMaxPrice(AHB_WHITE , fields[20].Get<uint32>());
+    SetMinPrice(AHB_GREEN , fields[21].Get<uint32>());
+    SetMaxPrice(AHB_GREEN , fields[22].Get<uint32>());
+    SetMinPrice(AHB_BLUE  , fields[23].Get<uint32>());
+    SetMaxPrice(AHB_BLUE  , fields[24].Get<uint32>());
+    SetMinPrice(AHB_PURPLE, fields[25].Get<uint32>());
+    SetMaxPrice(AHB_PURPLE, fields[26].Get<uint32>());
+    SetMinPrice(AHB_ORANGE, fields[27].Get<uint32>());
+    SetMaxPrice(AHB_ORANGE, fields[28].Get<uint32>());
+    SetMinPrice(AHB_YELLOW, fields[29].Get<uint32>());
+    SetMaxPrice(AHB_YELLOW, fields[30].Get<uint32>());
 
     // 
     // Load min and max bid prices
     // 
 
-    SetMinBidPrice(AHB_GREY  , WorldDatabase.Query("SELECT minbidpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_GREY  , WorldDatabase.Query("SELECT maxbidpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_WHITE , WorldDatabase.Query("SELECT minbidpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_WHITE , WorldDatabase.Query("SELECT maxbidpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_GREEN , WorldDatabase.Query("SELECT minbidpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_GREEN , WorldDatabase.Query("SELECT maxbidpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_BLUE  , WorldDatabase.Query("SELECT minbidpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_BLUE  , WorldDatabase.Query("SELECT maxbidpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_PURPLE, WorldDatabase.Query("SELECT minbidpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_PURPLE, WorldDatabase.Query("SELECT maxbidpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_ORANGE, WorldDatabase.Query("SELECT minbidpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_ORANGE, WorldDatabase.Query("SELECT maxbidpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMinBidPrice(AHB_YELLOW, WorldDatabase.Query("SELECT minbidpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxBidPrice(AHB_YELLOW, WorldDatabase.Query("SELECT maxbidpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    SetMinBidPrice(AHB_GREY  , fields[31].Get<uint32>());
+    SetMaxBidPrice(AHB_GREY  , fields[32].Get<uint32>());
+    SetMinBidPrice(AHB_WHITE , fields[33].Get<uint32>());
+    SetMaxBidPrice(AHB_WHITE , fields[34].Get<uint32>());
+    SetMinBidPrice(AHB_GREEN , fields[35].Get<uint32>());
+    SetMaxBidPrice(AHB_GREEN , fields[36].Get<uint32>());
+    SetMinBidPrice(AHB_BLUE  , fields[37].Get<uint32>());
+    SetMaxBidPrice(AHB_BLUE  , fields[38].Get<uint32>());
+    SetMinBidPrice(AHB_PURPLE, fields[39].Get<uint32>());
+    SetMaxBidPrice(AHB_PURPLE, fields[40].Get<uint32>());
+    SetMinBidPrice(AHB_ORANGE, fields[41].Get<uint32>());
+    SetMaxBidPrice(AHB_ORANGE, fields[42].Get<uint32>());
+    SetMinBidPrice(AHB_YELLOW, fields[43].Get<uint32>());
+    SetMaxBidPrice(AHB_YELLOW, fields[44].Get<uint32>());
 
     // 
     // Load max stacks
     // 
 
-    SetMaxStack(AHB_GREY  , WorldDatabase.Query("SELECT maxstackgrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_WHITE , WorldDatabase.Query("SELECT maxstackwhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_GREEN , WorldDatabase.Query("SELECT maxstackgreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_BLUE  , WorldDatabase.Query("SELECT maxstackblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_PURPLE, WorldDatabase.Query("SELECT maxstackpurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_ORANGE, WorldDatabase.Query("SELECT maxstackorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetMaxStack(AHB_YELLOW, WorldDatabase.Query("SELECT maxstackyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    SetMaxStack(AHB_GREY  , fields[45].Get<uint32>());
+    SetMaxStack(AHB_WHITE , fields[46].Get<uint32>());
+    SetMaxStack(AHB_GREEN , fields[47].Get<uint32>());
+    SetMaxStack(AHB_BLUE  , fields[48].Get<uint32>());
+    SetMaxStack(AHB_PURPLE, fields[49].Get<uint32>());
+    SetMaxStack(AHB_ORANGE, fields[50].Get<uint32>());
+    SetMaxStack(AHB_YELLOW, fields[51].Get<uint32>());
 
     if (DebugOutConfig)
     {
@@ -2307,195 +2363,211 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
     }
 
     //
-    // Reset the situation of the auction house
+    // Auctions buyer
+    //
+
+    SetBuyerPrice(AHB_GREY  , fields[52].Get<uint32>());
+    SetBuyerPrice(AHB_WHITE , fields[53].Get<uint32>());
+    SetBuyerPrice(AHB_GREEN , fields[54].Get<uint32>());
+    SetBuyerPrice(AHB_BLUE  , fields[55].Get<uint32>());
+    SetBuyerPrice(AHB_PURPLE, fields[56].Get<uint32>());
+    SetBuyerPrice(AHB_ORANGE, fields[57].Get<uint32>());
+    SetBuyerPrice(AHB_YELLOW, fields[58].Get<uint32>());
+
+    //
+    // Load bidding interval
+    //
+
+    SetBiddingInterval(fields[59].Get<uint32>());
+
+    //
+    // Load bids per interval
+    //
+
+    SetBidsPerInterval(fields[60].Get<uint32>());
+
+    if (DebugOutConfig)
+    {
+        LOG_INFO("module", "Current Settings for Auctionhouse {} buyer", GetAHID());
+        LOG_INFO("module", "buyerPriceGrey          = {}", GetBuyerPrice(AHB_GREY));
+        LOG_INFO("module", "buyerPriceWhite         = {}", GetBuyerPrice(AHB_WHITE));
+        LOG_INFO("module", "buyerPriceGreen         = {}", GetBuyerPrice(AHB_GREEN));
+        LOG_INFO("module", "buyerPriceBlue          = {}", GetBuyerPrice(AHB_BLUE));
+        LOG_INFO("module", "buyerPricePurple        = {}", GetBuyerPrice(AHB_PURPLE));
+        LOG_INFO("module", "buyerPriceOrange        = {}", GetBuyerPrice(AHB_ORANGE));
+        LOG_INFO("module", "buyerPriceYellow        = {}", GetBuyerPrice(AHB_YELLOW));
+        LOG_INFO("module", "buyerBiddingInterval    = {}", GetBiddingInterval());
+        LOG_INFO("module", "buyerBidsPerInterval    = {}", GetBidsPerInterval());
+    }
+}
+
+uint32 AHBConfig::GetItemCategory(uint32 Class, uint32 Quality)
+{
+    //
+    // Category of an item in the AHB_* classification, AHB_CATEGORIES if it is not handled by the bots
     //
 
-    ResetItemCounts();
+    if (Quality > AHB_MAX_QUALITY)
+    {
+        return AHB_CATEGORIES;
+    }
+
+    if (Class == ITEM_CLASS_TRADE_GOODS)
+    {
+        return Quality;
+    }
+
+    return Quality + AHB_ITEM_TYPE_OFFSET;
+}
 
+AHBCensus AHBConfig::TakeCensus(AuctionHouseObject* auctionHouse, std::set<uint32> const& botsIds, std::vector<AHBConfig*> const& configs)
+{
     //
-    // Update the situation of the auction house
+    // A single pass over the auctions: it counts them by owner and category, and feeds the
+    // counters and the indexes of all the configurations operating on this auction house.
     //
 
-    AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(GetAHFID());
-    uint32 numberOfAuctions = auctionHouse->Getcount();
+    AHBCensus census = {};
 
-    if (numberOfAuctions > 0)
+    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
     {
-        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+        AuctionEntry* Aentry      = itr->second;
+        bool          activeBot   = botsIds.find(Aentry->owner.GetCounter())  != botsIds.end();
+        bool          ownedByBot  = activeBot || IsBot(Aentry->owner.GetCounter());
+        bool          bidByBot    = IsBot(Aentry->bidder.GetCounter());
+        uint32        category    = AHB_CATEGORIES;
+
+        ItemTemplate const* prototype = sObjectMgr->GetItemTemplate(Aentry->item_template);
+
+        if (prototype)
+        {
+            category = GetItemCategory(prototype->Class, prototype->Quality);
+        }
+
+        if (category < AHB_CATEGORIES)
         {
-            AuctionEntry* Aentry = itr->second;
-            Item*         item   = sAuctionMgr->GetAItem(Aentry->item_guid);
+            if (ownedByBot)
+            {
+                census.BotAuctions[category]++;
+            }
+            else
+            {
+                census.PlayerAuctions[category]++;
+            }
+        }
 
+        for (AHBConfig* config : configs)
+        {
             //
-            // If it has to only consider the bots auctions, skip the ones belonging to the players
+            // Index the auctions owned by the bots and the ones the buyer can bid on
             //
 
-            if (ConsiderOnlyBotAuctions)
+            if (activeBot)
             {
-                if (botsIds.find(Aentry->owner.GetCounter()) == botsIds.end())
-                {
-                    continue;
-                }
+                config->IncBotAuctions(Aentry->owner.GetCounter(), Aentry->item_template);
+                config->AddExpiry(Aentry->expire_time);
+            }
+            else if (!ownedByBot && !bidByBot)
+            {
+                config->AddBuyerCandidate(Aentry->Id);
+            }
+
+            //
+            // Index the prices the players are asking, the competition of the bots listings
+            //
+
+            if (!ownedByBot)
+            {
+                config->AddListing(Aentry->item_template, Aentry->itemCount, Aentry->buyout);
             }
 
-            if (item)
+            //
+            // Seed the market prices from what the players are asking; the bots listings are left
+            // out, as they are priced from the very prices being seeded
+            //
+
+            if (!ownedByBot && config->MarketWarmStart)
             {
-                ItemTemplate const* prototype = item->GetTemplate();
+                config->SeedItemStats(Aentry->item_template, Aentry->itemCount, Aentry->buyout);
+            }
 
-                if (prototype)
-                {
-                    switch (prototype->Quality)
-                    {
-                    case AHB_GREY:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_GREY_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_GREY_I);
-                        }
-                        break;
-
-                    case AHB_WHITE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_WHITE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_WHITE_I);
-                        }
-
-                        break;
-
-                    case AHB_GREEN:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_GREEN_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_GREEN_I);
-                        }
-
-                        break;
-
-                    case AHB_BLUE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_BLUE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_BLUE_I);
-                        }
-
-                        break;
-
-                    case AHB_PURPLE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_PURPLE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_PURPLE_I);
-                        }
-
-                        break;
-
-                    case AHB_ORANGE:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_ORANGE_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_ORANGE_I);
-                        }
-
-                        break;
-
-                    case AHB_YELLOW:
-                        if (prototype->Class == ITEM_CLASS_TRADE_GOODS)
-                        {
-                            IncItemCounts(AHB_YELLOW_TG);
-                        }
-                        else
-                        {
-                            IncItemCounts(AHB_YELLOW_I);
-                        }
-
-                        break;
-                    }
-                }
+            //
+            // If it has to only consider the bots auctions, skip the ones belonging to the players
+            //
+
+            if (category < AHB_CATEGORIES && (ownedByBot || !config->ConsiderOnlyBotAuctions))
+            {
+                config->IncItemCounts(category);
             }
         }
     }
 
-    if (DebugOutConfig)
-    {
-        LOG_INFO("module", "Current situation for the auctionhouse {}", GetAHID());
-        LOG_INFO("module", "    Grey   Trade Goods {}", GetItemCounts(AHB_GREY_TG));
-        LOG_INFO("module", "    White  Trade Goods {}", GetItemCounts(AHB_WHITE_TG));
-        LOG_INFO("module", "    Green  Trade Goods {}", GetItemCounts(AHB_GREEN_TG));
-        LOG_INFO("module", "    Blue   Trade Goods {}", GetItemCounts(AHB_BLUE_TG));
-        LOG_INFO("module", "    Purple Trade Goods {}", GetItemCounts(AHB_PURPLE_TG));
-        LOG_INFO("module", "    Orange Trade Goods {}", GetItemCounts(AHB_ORANGE_TG));
-        LOG_INFO("module", "    Yellow Trade Goods {}", GetItemCounts(AHB_YELLOW_TG));
-        LOG_INFO("module", "    Grey   Items       {}", GetItemCounts(AHB_GREY_I));
-        LOG_INFO("module", "    White  Items       {}", GetItemCounts(AHB_WHITE_I));
-        LOG_INFO("module", "    Green  Items       {}", GetItemCounts(AHB_GREEN_I));
-        LOG_INFO("module", "    Blue   Items       {}", GetItemCounts(AHB_BLUE_I));
-        LOG_INFO("module", "    Purple Items       {}", GetItemCounts(AHB_PURPLE_I));
-        LOG_INFO("module", "    Orange Items       {}", GetItemCounts(AHB_ORANGE_I));
-        LOG_INFO("module", "    Yellow Items       {}", GetItemCounts(AHB_YELLOW_I));
-    }
+    return census;
+}
 
+void AHBConfig::InitializeFromSql(std::vector<AHBConfig*> const& configs, std::set<uint32> const& botsIds)
+{
     //
-    // Auctions buyer
+    // Reset the situation of the auction houses
     //
 
-    SetBuyerPrice(AHB_GREY  , WorldDatabase.Query("SELECT buyerpricegrey   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_WHITE , WorldDatabase.Query("SELECT buyerpricewhite  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_GREEN , WorldDatabase.Query("SELECT buyerpricegreen  FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_BLUE  , WorldDatabase.Query("SELECT buyerpriceblue   FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_PURPLE, WorldDatabase.Query("SELECT buyerpricepurple FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_ORANGE, WorldDatabase.Query("SELECT buyerpriceorange FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
-    SetBuyerPrice(AHB_YELLOW, WorldDatabase.Query("SELECT buyerpriceyellow FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    std::map<AuctionHouseObject*, std::vector<AHBConfig*>> houses;
 
-    //
-    // Load bidding interval
-    //
+    for (AHBConfig* config : configs)
+    {
+        config->ResetItemCounts();
+        config->ResetBotAuctions();
+        config->ResetBuyerCandidates();
+        config->ResetListings();
+        config->ResetExpiries();
 
-    SetBiddingInterval(WorldDatabase.Query("SELECT buyerbiddinginterval FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+        houses[sAuctionMgr->GetAuctionsMap(config->GetAHFID())].push_back(config);
+    }
 
     //
-    // Load bids per interval
+    // Update the situation with one census for each distinct auction house: when the factions
+    // share the same auction house, it is scanned only once for all of them.
     //
 
-    SetBidsPerInterval(WorldDatabase.Query("SELECT buyerbidsperinterval FROM mod_auctionhousebot WHERE auctionhouse = {}", GetAHID())->Fetch()->Get<uint32>());
+    for (std::map<AuctionHouseObject*, std::vector<AHBConfig*>>::const_iterator it = houses.begin(); it != houses.end(); ++it)
+    {
+        TakeCensus(it->first, botsIds, it->second);
+    }
 
-    if (DebugOutConfig)
+    for (AHBConfig* config : configs)
     {
-        LOG_INFO("module", "Current Settings for Auctionhouse {} buyer", GetAHID());
-        LOG_INFO("module", "buyerPriceGrey          = {}", GetBuyerPrice(AHB_GREY));
-        LOG_INFO("module", "buyerPriceWhite         = {}", GetBuyerPrice(AHB_WHITE));
-        LOG_INFO("module", "buyerPriceGreen         = {}", GetBuyerPrice(AHB_GREEN));
-        LOG_INFO("module", "buyerPriceBlue          = {}", GetBuyerPrice(AHB_BLUE));
-        LOG_INFO("module", "buyerPricePurple        = {}", GetBuyerPrice(AHB_PURPLE));
-        LOG_INFO("module", "buyerPriceOrange        = {}", GetBuyerPrice(AHB_ORANGE));
-        LOG_INFO("module", "buyerPriceYellow        = {}", GetBuyerPrice(AHB_YELLOW));
-        LOG_INFO("module", "buyerBiddingInterval    = {}", GetBiddingInterval());
-        LOG_INFO("module", "buyerBidsPerInterval    = {}", GetBidsPerInterval());
+        if (config->DebugOutConfig)
+        {
+            LOG_INFO("module", "Current situation for the auctionhouse {}", config->GetAHID());
+            LOG_INFO("module", "    Grey   Trade Goods {}", config->GetItemCounts(AHB_GREY_TG));
+            LOG_INFO("module", "    White  Trade Goods {}", config->GetItemCounts(AHB_WHITE_TG));
+            LOG_INFO("module", "    Green  Trade Goods {}", config->GetItemCounts(AHB_GREEN_TG));
+            LOG_INFO("module", "    Blue   Trade Goods {}", config->GetItemCounts(AHB_BLUE_TG));
+            LOG_INFO("module", "    Purple Trade Goods {}", config->GetItemCounts(AHB_PURPLE_TG));
+            LOG_INFO("module", "    Orange Trade Goods {}", config->GetItemCounts(AHB_ORANGE_TG));
+            LOG_INFO("module", "    Yellow Trade Goods {}", config->GetItemCounts(AHB_YELLOW_TG));
+            LOG_INFO("module", "    Grey   Items       {}", config->GetItemCounts(AHB_GREY_I));
+            LOG_INFO("module", "    White  Items       {}", config->GetItemCounts(AHB_WHITE_I));
+            LOG_INFO("module", "    Green  Items       {}", config->GetItemCounts(AHB_GREEN_I));
+            LOG_INFO("module", "    Blue   Items       {}", config->GetItemCounts(AHB_BLUE_I));
+            LOG_INFO("module", "    Purple Items       {}", config->GetItemCounts(AHB_PURPLE_I));
+            LOG_INFO("module", "    Orange Items       {}", config->GetItemCounts(AHB_ORANGE_I));
+            LOG_INFO("module", "    Yellow Items       {}", config->GetItemCounts(AHB_YELLOW_I));
+        }
     }
+}
 
+std::shared_ptr<AHBSources const> AHBConfig::LoadSources(bool professionItems, bool debug)
+{
     //
-    // Reload the list of disabled items
+    // The sources are the same for all the auction houses, so they are loaded once and shared
     //
 
-    DisableItemStore.clear();
+    std::shared_ptr<AHBSources> sources = NewSources();
+
+    //
+    // Load the list of disabled items
+    //
 
     QueryResult result = WorldDatabase.Query("SELECT item FROM mod_auctionhousebot_disabled_items");
 
@@ -2504,21 +2576,19 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
         do
         {
             Field* fields = result->Fetch();
-            DisableItemStore.insert(fields[0].Get<uint32>());
+            sources->DisableItemStore.Insert(fields[0].Get<uint32>());
         } while (result->NextRow());
     }
 
-    if (DebugOutConfig)
+    if (debug)
     {
-        LOG_INFO("module", "Loaded {} items from the disabled item store", uint32(DisableItemStore.size()));
+        LOG_INFO("module", "Loaded {} items from the disabled item store", uint32(sources->DisableItemStore.Size()));
     }
 
     // 
-    // Reload the list of npc items
+    // Load the list of npc items
     // 
 
-    NpcItems.clear();
-
     QueryResult npcResults = WorldDatabase.Query("SELECT distinct item FROM npc_vendor");
 
     if (npcResults)
@@ -2526,29 +2596,36 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
         do
         {
             Field* fields = npcResults->Fetch();
-            NpcItems.insert(fields[0].Get<int32>());
+            int32  item   = fields[0].Get<int32>();
+
+            //
+            // Negative entries are references to other vendors lists, not items
+            //
+
+            if (item > 0)
+            {
+                sources->NpcItems.Insert(uint32(item));
+            }
 
         } while (npcResults->NextRow());
     }
     else
     {
-        if (DebugOutConfig)
+        if (debug)
         {
             LOG_ERROR("module", "AuctionHouseBot: failed to retrieve npc items");
         }
     }
 
-    if (DebugOutConfig)
+    if (debug)
     {
-        LOG_INFO("module", "Loaded {} items from NPCs", uint32(NpcItems.size()));
+        LOG_INFO("module", "Loaded {} items from NPCs", uint32(sources->NpcItems.Size()));
     }
 
     // 
-    // Reload the list from the lootable items
+    // Load the list from the lootable items
     // 
 
-    LootItems.clear();
-
     QueryResult itemsResults = WorldDatabase.Query(
         "SELECT item FROM creature_loot_template      UNION "
         "SELECT item FROM reference_loot_template     UNION "
@@ -2566,13 +2643,13 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
         do
         {
             Field* fields = itemsResults->Fetch();
-            LootItems.insert(fields[0].Get<uint32>());
+            sources->LootItems.Insert(fields[0].Get<uint32>());
 
         } while (itemsResults->NextRow());
     }
     else
     {
-        if (DebugOutConfig)
+        if (debug)
         {
             LOG_ERROR("module", "AuctionHouseBot: failed to retrieve loot items");
         }
@@ -2582,7 +2659,7 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
     // Include profession items
     //
 
-    if (Profession_Items)
+    if (professionItems)
     {
         itemsResults = WorldDatabase.Query(
             "SELECT item FROM auctionhousebot_professionItems");
@@ -2593,23 +2670,222 @@ void AHBConfig::InitializeFromSql(std::set<uint32> botsIds)
             {
                 Field* fields = itemsResults->Fetch();
                 uint32 item   = fields[0].Get<uint32>();
-                
-                if(LootItems.find(item) == LootItems.end())
-                {
-                    LootItems.insert(fields[0].Get<uint32>());
-                }
+
+                sources->LootItems.Insert(item);
             } while (itemsResults->NextRow());
         }
     }
 
-    if (DebugOutConfig)
+    if (debug)
     {
-        LOG_INFO("module", "Loaded {} items from lootable items", uint32(LootItems.size()));
+        LOG_INFO("module", "Loaded {} items from lootable items", uint32(sources->LootItems.Size()));
     }
+
+    return sources;
+}
+
+std::shared_ptr<AHBSources> AHBConfig::NewSources()
+{
+    static uint32 sourcesId = 0;
+
+    std::shared_ptr<AHBSources> sources = std::make_shared<AHBSources>();
+    sources->Id                         = ++sourcesId;
+
+    return sources;
+}
+
+void AHBConfig::SetSources(std::shared_ptr<AHBSources const> sources)
+{
+    Sources = sources;
+}
+
+void AHBConfig::RegisterBins(uint64 filtersHash, std::shared_ptr<AHBSources const> const& sources, std::shared_ptr<AHBBins const> const& bins)
+{
+    //
+    // Make bins built elsewhere (i.e. loaded from the cache) available to InitializeBins; the caller keeps them alive
+    //
+
+    std::lock_guard<std::mutex> guard(gBinsRegistryLock);
+
+    gBinsRegistry[GetBinsKey(filtersHash, sources->Id)] = bins;
+}
+
+uint64 AHBConfig::GetFiltersHash()
+{
+    //
+    // FNV-1a over every setting read by BuildBins. It does not depend on the sources, so it is
+    // stable across restarts and can key the bins cache.
+    //
+
+    uint64 hash = 14695981039346656037ULL;
+
+    auto mix = [&hash](uint64 value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+
+    mix(SellerWhiteList.Hash());
+    mix(UseBuyPriceForSeller);
+
+    mix(Vendor_Items);
+    mix(Loot_Items);
+    mix(Other_Items);
+    mix(Vendor_TGs);
+    mix(Loot_TGs);
+    mix(Other_TGs);
+
+    mix(No_Bind);
+    mix(Bind_When_Picked_Up);
+    mix(Bind_When_Equipped);
+    mix(Bind_When_Use);
+    mix(Bind_Quest_Item);
+
+    mix(DisablePermEnchant);
+    mix(DisableConjured);
+    mix(DisableGems);
+    mix(DisableMoney);
+    mix(DisableMoneyLoot);
+    mix(DisableLootable);
+    mix(DisableKeys);
+    mix(DisableDuration);
+    mix(DisableBOP_Or_Quest_NoReqLevel);
+
+    mix(DisableWarriorItems);
+    mix(DisablePaladinItems);
+    mix(DisableHunterItems);
+    mix(DisableRogueItems);
+    mix(DisablePriestItems);
+    mix(DisableDKItems);
+    mix(DisableShamanItems);
+    mix(DisableMageItems);
+    mix(DisableWarlockItems);
+    mix(DisableUnusedClassItems);
+    mix(DisableDruidItems);
+
+    mix(DisableItemsBelowLevel);
+    mix(DisableItemsAboveLevel);
+    mix(DisableTGsBelowLevel);
+    mix(DisableTGsAboveLevel);
+    mix(DisableItemsBelowGUID);
+    mix(DisableItemsAboveGUID);
+    mix(DisableTGsBelowGUID);
+    mix(DisableTGsAboveGUID);
+    mix(DisableItemsBelowReqLevel);
+    mix(DisableItemsAboveReqLevel);
+    mix(DisableTGsBelowReqLevel);
+    mix(DisableTGsAboveReqLevel);
+    mix(DisableItemsBelowReqSkillRank);
+    mix(DisableItemsAboveReqSkillRank);
+    mix(DisableTGsBelowReqSkillRank);
+    mix(DisableTGsAboveReqSkillRank);
+
+    return hash;
 }
 
 void AHBConfig::InitializeBins()
 {
+    uint32 startTime = getMSTime();
+
+    Bins.reset();
+
+    if (!Sources)
+    {
+        LOG_ERROR("module", "AHBot: no items sources loaded for ah {}, selling will be disabled", AHID);
+        return;
+    }
+
+    //
+    // The bins depend only on the filters: if another configuration already built them with
+    // the same filters, share its copy, otherwise build and register them.
+    //
+
+    uint64 binsKey = GetBinsKey(GetFiltersHash(), Sources->Id);
+    bool   shared  = false;
+
+    {
+        std::lock_guard<std::mutex> guard(gBinsRegistryLock);
+
+        std::map<uint64, std::weak_ptr<AHBBins const>>::iterator it = gBinsRegistry.find(binsKey);
+
+        if (it != gBinsRegistry.end())
+        {
+            Bins = it->second.lock();
+        }
+    }
+
+    if (Bins)
+    {
+        shared = true;
+    }
+    else
+    {
+        Bins = BuildBins();
+
+        std::lock_guard<std::mutex> guard(gBinsRegistryLock);
+
+        for (std::map<uint64, std::weak_ptr<AHBBins const>>::iterator it = gBinsRegistry.begin(); it != gBinsRegistry.end();)
+        {
+            if (it->second.expired())
+            {
+                it = gBinsRegistry.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        gBinsRegistry[binsKey] = Bins;
+    }
+
+    // 
+    // Perform reporting and the last check: if no items are disabled or in the whitelist clear the bin making the selling useless
+    // 
+
+    LOG_INFO("module", "AHBot: Configuration for ah {}", AHID);
+    LOG_INFO("module", "AHBot: bins {} in {} ms", shared ? "shared" : "built", getMSTimeDiff(startTime, getMSTime()));
+
+    if (SellerWhiteList.Size() == 0)
+    {
+        if (Sources->DisableItemStore.Size() == 0)
+        {
+            LOG_ERROR("module", "AHBot: No items are disabled or in the whitelist! Selling will be disabled!");
+
+            Bins.reset();
+
+            AHBSeller = false;
+
+            return;
+        }
+
+        LOG_INFO("module", "AHBot: {} disabled items", uint32(Sources->DisableItemStore.Size()));
+    }
+    else
+    {
+        LOG_INFO("module", "AHBot: Using a whitelist of {} items", uint32(SellerWhiteList.Size()));
+    }
+
+    LOG_INFO("module", "AHBot: loaded {} grey   trade goods", uint32(Bins->Bin[AHB_GREY_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} white  trade goods", uint32(Bins->Bin[AHB_WHITE_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} green  trade goods", uint32(Bins->Bin[AHB_GREEN_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} blue   trade goods", uint32(Bins->Bin[AHB_BLUE_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} purple trade goods", uint32(Bins->Bin[AHB_PURPLE_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} orange trade goods", uint32(Bins->Bin[AHB_ORANGE_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} yellow trade goods", uint32(Bins->Bin[AHB_YELLOW_TG].size()));
+    LOG_INFO("module", "AHBot: loaded {} grey   items"      , uint32(Bins->Bin[AHB_GREY_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} white  items"      , uint32(Bins->Bin[AHB_WHITE_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} green  items"      , uint32(Bins->Bin[AHB_GREEN_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} blue   items"      , uint32(Bins->Bin[AHB_BLUE_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} purple items"      , uint32(Bins->Bin[AHB_PURPLE_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} orange items"      , uint32(Bins->Bin[AHB_ORANGE_I].size()));
+    LOG_INFO("module", "AHBot: loaded {} yellow items"      , uint32(Bins->Bin[AHB_YELLOW_I].size()));
+}
+
+std::shared_ptr<AHBBins const> AHBConfig::BuildBins()
+{
+    std::shared_ptr<AHBBins> bins = std::make_shared<AHBBins>();
+
     //
     // Exclude items depending on the configuration; whatever passes all the tests is put in the lists.
     //
@@ -2695,7 +2971,7 @@ void AHBConfig::InitializeBins()
             bool isLoot  = false;
             bool exclude = false;
 
-            if (NpcItems.find(itr->second.ItemId) != NpcItems.end())
+            if (Sources->NpcItems.Contains(itr->second.ItemId))
             {
                 isNpc = true;
 
@@ -2707,7 +2983,7 @@ void AHBConfig::InitializeBins()
 
             if (!exclude)
             {
-                if (LootItems.find(itr->second.ItemId) != LootItems.end())
+                if (Sources->LootItems.Contains(itr->second.ItemId))
                 {
                     isLoot = true;
 
@@ -2742,7 +3018,7 @@ void AHBConfig::InitializeBins()
             bool isLoot  = false;
             bool exclude = false;
 
-            if (NpcItems.find(itr->second.ItemId) != NpcItems.end())
+            if (Sources->NpcItems.Contains(itr->second.ItemId))
             {
                 isNpc = true;
 
@@ -2754,7 +3030,7 @@ void AHBConfig::InitializeBins()
 
             if (!exclude)
             {
-                if (LootItems.find(itr->second.ItemId) != LootItems.end())
+                if (Sources->LootItems.Contains(itr->second.ItemId))
                 {
                     isLoot = true;
 
@@ -2783,9 +3059,9 @@ void AHBConfig::InitializeBins()
         // Verify if the item is disabled or not in the whitelist
         //
 
-        if (SellerWhiteList.size() == 0)
+        if (SellerWhiteList.Size() == 0)
         {
-            if (DisableItemStore.find(itr->second.ItemId) != DisableItemStore.end())
+            if (Sources->DisableItemStore.Contains(itr->second.ItemId))
             {
                 if (DebugOutFilters)
                 {
@@ -2797,7 +3073,7 @@ void AHBConfig::InitializeBins()
         }
         else
         {
-            if (SellerWhiteList.find(itr->second.ItemId) == SellerWhiteList.end())
+            if (!SellerWhiteList.Contains(itr->second.ItemId))
             {
                 if (DebugOutFilters)
                 {
@@ -3313,130 +3589,18 @@ void AHBConfig::InitializeBins()
         }
 
         //
-        // Now that the items passed all the tests, organize it by quality
+        // Now that the items passed all the tests, organize it by category
         //
 
-        if (itr->second.Class == ITEM_CLASS_TRADE_GOODS)
-        {
-            switch (itr->second.Quality)
-            {
-            case AHB_GREY:
-                GreyTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_WHITE:
-                WhiteTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_GREEN:
-                GreenTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_BLUE:
-                BlueTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_PURPLE:
-                PurpleTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_ORANGE:
-                OrangeTradeGoodsBin.insert(itr->second.ItemId);
-                break;
+        uint32 category = GetItemCategory(itr->second.Class, itr->second.Quality);
 
-            case AHB_YELLOW:
-                YellowTradeGoodsBin.insert(itr->second.ItemId);
-                break;
-            }
-        }
-        else
+        if (category < AHB_CATEGORIES)
         {
-            switch (itr->second.Quality)
-            {
-            case AHB_GREY:
-                GreyItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_WHITE:
-                WhiteItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_GREEN:
-                GreenItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_BLUE:
-                BlueItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_PURPLE:
-                PurpleItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_ORANGE:
-                OrangeItemsBin.insert(itr->second.ItemId);
-                break;
-
-            case AHB_YELLOW:
-                YellowItemsBin.insert(itr->second.ItemId);
-                break;
-            }
+            bins->Bin[category].push_back(itr->second.ItemId);
         }
     }
 
-    // 
-    // Perform reporting and the last check: if no items are disabled or in the whitelist clear the bin making the selling useless
-    // 
-
-    LOG_INFO("module", "AHBot: Configuration for ah {}", AHID);
-
-    if (SellerWhiteList.size() == 0)
-    {
-        if (DisableItemStore.size() == 0)
-        {
-            LOG_ERROR("module", "AHBot: No items are disabled or in the whitelist! Selling will be disabled!");
-
-            GreyTradeGoodsBin.clear();
-            WhiteTradeGoodsBin.clear();
-            GreenTradeGoodsBin.clear();
-            BlueTradeGoodsBin.clear();
-            PurpleTradeGoodsBin.clear();
-            OrangeTradeGoodsBin.clear();
-            YellowTradeGoodsBin.clear();
-            GreyItemsBin.clear();
-            WhiteItemsBin.clear();
-            GreenItemsBin.clear();
-            BlueItemsBin.clear();
-            PurpleItemsBin.clear();
-            OrangeItemsBin.clear();
-            YellowItemsBin.clear();
-
-            AHBSeller = false;
-
-            return;
-        }
-
-        LOG_INFO("module", "AHBot: {} disabled items", uint32(DisableItemStore.size()));
-    }
-    else
-    {
-        LOG_INFO("module", "AHBot: Using a whitelist of {} items", uint32(SellerWhiteList.size()));
-    }
-
-    LOG_INFO("module", "AHBot: loaded {} grey   trade goods", uint32(GreyTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} white  trade goods", uint32(WhiteTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} green  trade goods", uint32(GreenTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} blue   trade goods", uint32(BlueTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} purple trade goods", uint32(PurpleTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} orange trade goods", uint32(OrangeTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} yellow trade goods", uint32(YellowTradeGoodsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} grey   items"      , uint32(GreyItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} white  items"      , uint32(WhiteItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} green  items"      , uint32(GreenItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} blue   items"      , uint32(BlueItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} purple items"      , uint32(PurpleItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} orange items"      , uint32(OrangeItemsBin.size()));
-    LOG_INFO("module", "AHBot: loaded {} yellow items"      , uint32(YellowItemsBin.size()));
+    return bins;
 }
 
 std::set<uint32> AHBConfig::getCommaSeparatedIntegers(std::string text)
@@ -21,11 +21,57 @@
 #define AUCTION_HOUSE_BOT_CONFIG_H
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ObjectMgr.h"
 
+#include "AuctionHouseBotCommon.h"
+#include "AuctionHouseBotItemSet.h"
+#include "AuctionHouseBotMarket.h"
+
+class AuctionHouseObject;
+class Field;
+
+//
+// Auctions present in an auction house, by owner and category
+//
+
+struct AHBCensus
+{
+    uint32 BotAuctions   [AHB_CATEGORIES];
+    uint32 PlayerAuctions[AHB_CATEGORIES];
+};
+
+//
+// Sources of the items to sell, identical for all the auction houses: loaded once per (re)load and never modified afterwards
+//
+
+struct AHBSources
+{
+    uint32     Id;
+    AHBItemSet NpcItems;
+    AHBItemSet LootItems;
+    AHBItemSet DisableItemStore;
+};
+
+//
+// Bins of the items to sell, one per category. They depend only on the filters, so the configurations
+// with the same filters share one read only copy.
+//
+
+struct AHBBins
+{
+    //
+    // Indexed by AHB_* category; stored contiguously so that a random pick is a plain index access.
+    //
+
+    std::vector<uint32> Bin[AHB_CATEGORIES];
+};
+
 class AHBConfig
 {
 private:
@@ -35,21 +81,7 @@ private:
     uint32 minItems;
     uint32 maxItems;
 
-    uint32 percentGreyTradeGoods;
-    uint32 percentWhiteTradeGoods;
-    uint32 percentGreenTradeGoods;
-    uint32 percentBlueTradeGoods;
-    uint32 percentPurpleTradeGoods;
-    uint32 percentOrangeTradeGoods;
-    uint32 percentYellowTradeGoods;
-
-    uint32 percentGreyItems;
-    uint32 percentWhiteItems;
-    uint32 percentGreenItems;
-    uint32 percentBlueItems;
-    uint32 percentPurpleItems;
-    uint32 percentOrangeItems;
-    uint32 percentYellowItems;
+    uint32 percentages[AHB_CATEGORIES]; // Share of maxItems for each category
 
     uint32 minPriceGrey;
     uint32 maxPriceGrey;
@@ -104,58 +136,66 @@ private:
     uint32 buyerBidsPerInterval;
 
     //
-    // Amount of items to be sold in absolute values
+    // Amount of items to be sold in absolute values, and situation of the auction house, by category
     //
 
-    uint32 greytgp;
-    uint32 whitetgp;
-    uint32 greentgp;
-    uint32 bluetgp;
-    uint32 purpletgp;
-    uint32 orangetgp;
-    uint32 yellowtgp;
+    uint32 maxima[AHB_CATEGORIES];
+    uint32 counts[AHB_CATEGORIES];
 
-    uint32 greyip;
-    uint32 whiteip;
-    uint32 greenip;
-    uint32 blueip;
-    uint32 purpleip;
-    uint32 orangeip;
-    uint32 yellowip;
+    // 
+    // Per-item statistics
+    //
+
+    AHBMarket market;
+    time_t    marketSavedAt;
 
     //
-    // Situation of the auction house
+    // Outcome of the bots auctions by item, in a table of its own so that it never creates nor keeps alive
+    // the records of the prices; it is not saved
     //
 
-    uint32 greyTGoods;
-    uint32 whiteTGoods;
-    uint32 greenTGoods;
-    uint32 blueTGoods;
-    uint32 purpleTGoods;
-    uint32 orangeTGoods;
-    uint32 yellowTGoods;
+    AHBMarket outcomes;
 
-    uint32 greyItems;
-    uint32 whiteItems;
-    uint32 greenItems;
-    uint32 blueItems;
-    uint32 purpleItems;
-    uint32 orangeItems;
-    uint32 yellowItems;
+    //
+    // Outcome of the bots auctions by category, kept updated by the seller and the auction house hooks
+    //
 
-    // 
-    // Per-item statistics
+    uint32 listed[AHB_CATEGORIES];
+    uint32 sold[AHB_CATEGORIES];
+    uint32 expired[AHB_CATEGORIES];
+
+    //
+    // Auctions owned by the bots, kept updated by the auction house hooks
     //
 
-    std::map<uint32, uint32> itemsCount;
-    std::map<uint32, uint64> itemsSum;
-    std::map<uint32, uint64> itemsPrice;
+    std::unordered_map<uint32, uint32> botAuctions;     // Bot id -> number of auctions
+    std::unordered_map<uint64, uint32> botItemAuctions; // (Bot id, item template) -> number of auctions
 
-    void   InitializeFromFile();
-    void   InitializeFromSql(std::set<uint32> botsIds);
+    //
+    // Players auctions not yet bidded on by the bots, kept updated by the auction house hooks
+    //
+
+    std::set<uint32> buyerCandidates;
+    uint32           buyerCursor;
+
+    //
+    // Per unit buyouts of the players auctions, by item template, kept updated by the auction house hooks
+    //
+
+    std::unordered_map<uint32, std::multiset<uint64>> listings;
+
+    //
+    // Expirations of the bots auctions by minute, kept updated by the auction house hooks
+    //
+
+    std::map<uint32, uint32> expiries;
+
+    void   LoadSettings(Field* fields);
 
     std::set<uint32> getCommaSeparatedIntegers(std::string text);
 
+    std::shared_ptr<AHBBins const> BuildBins();
+
     void DecItemCounts(uint32 ahbotItemType);
     void IncItemCounts(uint32 ahbotItemType);
 
@@ -186,9 +226,18 @@ public:
     bool   UseBuyPriceForBuyer;
     bool   UseBuyPriceForSeller;
     bool   SellAtMarketPrice;
-    uint32 MarketResetThreshold;
+    uint32 MarketPriceHalfLife;
+    uint32 MarketMaxItems;
+    uint32 MarketSaveInterval;
+    uint32 MarketSaveUpdates;
+    bool   MarketWarmStart;
+    bool   UndercutCompetition;
+    bool   PreferSellingItems;
+    uint32 ExpiryPerMinute;
+    uint32 UndercutPercent;
     bool   ConsiderOnlyBotAuctions;
     uint32 ItemsPerCycle;
+    uint32 SellerBatchSize;
 
     //
     // Filters
@@ -262,34 +311,14 @@ public:
     // Items validity for selling purposes
     //
 
-    std::set<uint32> NpcItems;
-    std::set<uint32> LootItems;
-    std::set<uint32> DisableItemStore;
-    std::set<uint32> SellerWhiteList;
-
-    //
-    // Bins for trade goods.
-    //
-
-    std::set<uint32> GreyTradeGoodsBin;
-    std::set<uint32> WhiteTradeGoodsBin;
-    std::set<uint32> GreenTradeGoodsBin;
-    std::set<uint32> BlueTradeGoodsBin;
-    std::set<uint32> PurpleTradeGoodsBin;
-    std::set<uint32> OrangeTradeGoodsBin;
-    std::set<uint32> YellowTradeGoodsBin;
+    std::shared_ptr<AHBSources const> Sources;
+    AHBItemSet                        SellerWhiteList;
 
     //
-    // Bins for items
+    // Bins of the items to sell, shared with the configurations using the same filters
     //
 
-    std::set<uint32> GreyItemsBin;
-    std::set<uint32> WhiteItemsBin;
-    std::set<uint32> GreenItemsBin;
-    std::set<uint32> BlueItemsBin;
-    std::set<uint32> PurpleItemsBin;
-    std::set<uint32> OrangeItemsBin;
-    std::set<uint32> YellowItemsBin;
+    std::shared_ptr<AHBBins const> Bins;
 
     //
     // Constructors/destructors
@@ -304,10 +333,23 @@ public:
     // Ruotines
     //
 
-    void   Initialize(std::set<uint32> botsIds);
+    void   InitializeFromFile();
     void   InitializeBins();
     void   Reset();
 
+    uint64 GetFiltersHash();
+
+    static void LoadSettings(std::vector<AHBConfig*> const& configs);
+    static void InitializeFromSql(std::vector<AHBConfig*> const& configs, std::set<uint32> const& botsIds);
+
+    static uint32    GetItemCategory(uint32 Class, uint32 Quality);
+    static AHBCensus TakeCensus(AuctionHouseObject* auctionHouse, std::set<uint32> const& botsIds, std::vector<AHBConfig*> const& configs);
+    static std::shared_ptr<AHBSources const> LoadSources(bool professionItems, bool debug);
+    static std::shared_ptr<AHBSources>       NewSources();
+    static void                              RegisterBins(uint64 filtersHash, std::shared_ptr<AHBSources const> const& sources, std::shared_ptr<AHBBins const> const& bins);
+
+    void   SetSources(std::shared_ptr<AHBSources const> sources);
+
     uint32 GetAHID();
     uint32 GetAHFID();
 
@@ -348,6 +390,10 @@ public:
     void   CalculatePercents ();
     // max number of items of type in AH based on maxItems
     uint32 GetMaximum        (uint32 ahbotItemType);
+    // missing auctions of every category, returns their sum
+    uint32 GetDeficits       (uint32* deficits);
+    // bin of the items candidate for the given type
+    std::vector<uint32> const& GetBin(uint32 ahbotItemType);
     
     void   DecItemCounts     (uint32 Class, uint32 Quality);
 
@@ -359,8 +405,48 @@ public:
 
     uint32 GetItemCounts     (uint32 color);
 
+    void   IncBotAuctions    (uint32 botId, uint32 itemId);
+    void   DecBotAuctions    (uint32 botId, uint32 itemId);
+    void   ResetBotAuctions  ();
+    uint32 GetBotAuctions    (uint32 botId);
+    uint32 GetBotItemAuctions(uint32 botId, uint32 itemId);
+
+    void   AddBuyerCandidate   (uint32 auctionId);
+    void   RemoveBuyerCandidate(uint32 auctionId);
+    void   ResetBuyerCandidates();
+    uint32 GetBuyerCandidates  ();
+    uint32 NextBuyerCandidate  ();
+
+    void   AddListing        (uint32 itemId, uint32 stackSize, uint64 buyout);
+    void   RemoveListing     (uint32 itemId, uint32 stackSize, uint64 buyout);
+    void   ResetListings     ();
+    // lowest per unit buyout among the players auctions of the item, zero if none is listed
+    uint64 GetLowestListing  (uint32 itemId);
+    uint32 GetListings       (uint32 itemId);
+
+    void   AddExpiry         (time_t expireTime);
+    void   RemoveExpiry      (time_t expireTime);
+    void   ResetExpiries     ();
+    // bots auctions expiring in the same minute as the given time
+    uint32 GetExpiries       (time_t expireTime);
+    std::map<uint32, uint32> const& GetExpiryDistribution();
+
     void   UpdateItemStats   (uint32 id, uint32 stackSize, uint64 buyout);
+    void   SeedItemStats     (uint32 id, uint32 stackSize, uint64 buyout);
     uint64 GetItemPrice      (uint32 id);
+    void   CarryOverMarket   (AHBConfig* previous);
+
+    void   IncListed         (uint32 ahbotItemType);
+    void   UpdateSellThrough (uint32 id, bool success);
+    // share of the bots auctions of the item that sold, smoothed so that an unknown item is at one half
+    double GetSellThrough    (uint32 id);
+    uint32 GetListed         (uint32 ahbotItemType);
+    uint32 GetSold           (uint32 ahbotItemType);
+    uint32 GetExpired        (uint32 ahbotItemType);
+    void   SaveMarket        (bool shutdown);
+    bool   IsMarketSaved     ();
+
+    static void LoadMarkets(std::vector<AHBConfig*> const& configs);
 };
 
 //
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_ITEM_SET_H
+#define AUCTION_HOUSE_BOT_ITEM_SET_H
+
+#include <bitset>
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// Set of item ids stored as a bitmap indexed by the id itself. The ids of the
+// item templates are dense and bounded, so a lookup is a shift and a mask.
+// =============================================================================
+
+class AHBItemSet
+{
+private:
+    static constexpr uint32 MaxId = 1 << 24; // Ids above this are not items and are ignored, to bound the memory used
+
+    std::vector<uint64> _bits;
+    uint32              _size;
+
+public:
+    AHBItemSet()
+    {
+        _size = 0;
+    }
+
+    void Insert(uint32 id)
+    {
+        if (id >= MaxId)
+        {
+            return;
+        }
+
+        uint32 word = id >> 6;
+        uint64 mask = uint64(1) << (id & 63);
+
+        if (word >= _bits.size())
+        {
+            _bits.resize(word + 1, 0);
+        }
+
+        if ((_bits[word] & mask) == 0)
+        {
+            _bits[word] |= mask;
+            _size++;
+        }
+    }
+
+    bool Contains(uint32 id) const
+    {
+        uint32 word = id >> 6;
+
+        return word < _bits.size() && ((_bits[word] >> (id & 63)) & 1) != 0;
+    }
+
+    void Clear()
+    {
+        _bits.clear();
+        _size = 0;
+    }
+
+    uint32 Size() const
+    {
+        return _size;
+    }
+
+    //
+    // Raw access to the bitmap, used to persist the set
+    //
+
+    std::vector<uint64> const& Words() const
+    {
+        return _bits;
+    }
+
+    void Assign(std::vector<uint64> words)
+    {
+        _bits = std::move(words);
+        _size = 0;
+
+        for (uint64 word : _bits)
+        {
+            _size += uint32(std::bitset<64>(word).count());
+        }
+    }
+
+    uint64 Hash() const
+    {
+        uint64 hash = 14695981039346656037ULL;
+
+        for (uint64 word : _bits)
+        {
+            hash ^= word;
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+};
+
+#endif // AUCTION_HOUSE_BOT_ITEM_SET_H
@@ -27,7 +27,7 @@ void AHBot_MailScript::OnBeforeMailDraftSendMailTo(
     // If the mail is for the bot, then remove it and delete the items bought
     //
 
-    if (gBotsId.find(receiver.GetPlayerGUIDLow()) != gBotsId.end())
+    if (IsBot(receiver.GetPlayerGUIDLow()))
     {
         if (sender.GetMailMessageType() == MAIL_AUCTION)
         {
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#include <algorithm>
+
+#include "AuctionHouseBotMarket.h"
+
+AHBMarket::AHBMarket()
+{
+    _size  = 0;
+    _limit = 0;
+    _clock = 0;
+}
+
+uint32 AHBMarket::Slot(uint32 itemId) const
+{
+    //
+    // The item ids are dense, so they are mixed before being reduced to the table size
+    //
+
+    uint32 hash = itemId;
+
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+
+    return hash & uint32(_slots.size() - 1);
+}
+
+void AHBMarket::Rehash(uint32 capacity)
+{
+    std::vector<AHBMarketEntry> slots(capacity, AHBMarketEntry());
+
+    _slots.swap(slots);
+
+    for (AHBMarketEntry const& entry : slots)
+    {
+        if (entry.ItemId == 0)
+        {
+            continue;
+        }
+
+        uint32 index = Slot(entry.ItemId);
+
+        while (_slots[index].ItemId != 0)
+        {
+            index = (index + 1) & (capacity - 1);
+        }
+
+        _slots[index] = entry;
+    }
+}
+
+void AHBMarket::Evict(uint32 count)
+{
+    if (count == 0 || _size == 0)
+    {
+        return;
+    }
+
+    if (count >= _size)
+    {
+        Clear();
+        return;
+    }
+
+    //
+    // Find the update sequence of the count-th oldest item; the sequences are unique, so exactly count items are at or below it
+    //
+
+    std::vector<uint32> ages;
+    ages.reserve(_size);
+
+    for (AHBMarketEntry const& entry : _slots)
+    {
+        if (entry.ItemId != 0)
+        {
+            ages.push_back(entry.LastSeen);
+        }
+    }
+
+    std::nth_element(ages.begin(), ages.begin() + (count - 1), ages.end());
+
+    uint32 oldest = ages[count - 1];
+
+    for (AHBMarketEntry& entry : _slots)
+    {
+        if (entry.ItemId != 0 && entry.LastSeen <= oldest)
+        {
+            Release(entry);
+        }
+    }
+
+    //
+    // Rebuild the probe sequences broken by the freed slots
+    //
+
+    Rehash(uint32(_slots.size()));
+}
+
+AHBMarketEntry const* AHBMarket::Find(uint32 itemId) const
+{
+    if (_slots.empty())
+    {
+        return NULL;
+    }
+
+    uint32 index = Slot(itemId);
+
+    while (_slots[index].ItemId != 0)
+    {
+        if (_slots[index].ItemId == itemId)
+        {
+            return &_slots[index];
+        }
+
+        index = (index + 1) & uint32(_slots.size() - 1);
+    }
+
+    return NULL;
+}
+
+AHBMarketEntry& AHBMarket::Update(uint32 itemId)
+{
+    _clock++;
+
+    if (_slots.empty())
+    {
+        Rehash(64);
+    }
+
+    uint32 index = Slot(itemId);
+
+    while (_slots[index].ItemId != 0)
+    {
+        if (_slots[index].ItemId == itemId)
+        {
+            _slots[index].LastSeen = _clock;
+            return _slots[index];
+        }
+
+        index = (index + 1) & uint32(_slots.size() - 1);
+    }
+
+    //
+    // New item: make room for it first, dropping the oldest eighth of the table when the limit is reached
+    // and keeping the table at most half full
+    //
+
+    if (_limit != 0 && _size >= _limit)
+    {
+        Evict(std::max<uint32>(1, _limit / 8));
+    }
+
+    if ((_size + 1) * 2 > _slots.size())
+    {
+        Rehash(uint32(_slots.size() * 2));
+    }
+
+    index = Slot(itemId);
+
+    while (_slots[index].ItemId != 0)
+    {
+        index = (index + 1) & uint32(_slots.size() - 1);
+    }
+
+    AHBMarketEntry& entry = _slots[index];
+
+    entry          = AHBMarketEntry();
+    entry.ItemId   = itemId;
+    entry.LastSeen = _clock;
+
+    _size++;
+
+    return entry;
+}
+
+void AHBMarket::SetLimit(uint32 limit)
+{
+    _limit = limit;
+
+    if (_limit != 0 && _size > _limit)
+    {
+        Evict(_size - _limit);
+    }
+}
+
+void AHBMarket::Release(AHBMarketEntry& entry)
+{
+    //
+    // A record dropped before being saved is kept aside, so that it is still written with the next batch
+    //
+
+    if (entry.Dirty)
+    {
+        entry.Dirty = false;
+        _pending.push_back(entry);
+    }
+
+    entry.ItemId = 0;
+    _size--;
+}
+
+void AHBMarket::Clear()
+{
+    for (AHBMarketEntry& entry : _slots)
+    {
+        if (entry.ItemId != 0)
+        {
+            Release(entry);
+        }
+    }
+
+    _slots.clear();
+    _dirty.clear();
+    _size = 0;
+}
+
+uint32 AHBMarket::Size() const
+{
+    return _size;
+}
+
+void AHBMarket::MarkDirty(AHBMarketEntry& entry)
+{
+    if (!entry.Dirty)
+    {
+        entry.Dirty = true;
+        _dirty.push_back(entry.ItemId);
+    }
+}
+
+uint32 AHBMarket::GetDirtyCount() const
+{
+    return uint32(_dirty.size() + _pending.size());
+}
+
+std::vector<AHBMarketEntry> AHBMarket::TakeDirty()
+{
+    //
+    // The records dropped come first, so that an item dropped then added again is saved with
+    // its latest state. Items marked then dropped are not found anymore, and items dropped then
+    // added again may be listed twice: the flag makes sure each record is returned once.
+    //
+
+    std::vector<AHBMarketEntry> entries;
+    entries.swap(_pending);
+    entries.reserve(entries.size() + _dirty.size());
+
+    for (uint32 itemId : _dirty)
+    {
+        AHBMarketEntry* entry = const_cast<AHBMarketEntry*>(Find(itemId));
+
+        if (entry && entry->Dirty)
+        {
+            entry->Dirty = false;
+            entries.push_back(*entry);
+        }
+    }
+
+    _dirty.clear();
+
+    return entries;
+}
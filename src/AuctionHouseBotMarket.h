@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
+ */
+
+#ifndef AUCTION_HOUSE_BOT_MARKET_H
+#define AUCTION_HOUSE_BOT_MARKET_H
+
+#include <vector>
+
+#include "Common.h"
+
+// =============================================================================
+// Market statistics of the items, one record per item template, stored in a
+// flat open addressing table: an update or a lookup is a single probe
+// sequence over contiguous memory. The number of items tracked can be capped;
+// when the cap is reached the items not updated for the longest time are
+// evicted.
+// =============================================================================
+
+struct AHBMarketEntry
+{
+    uint32 ItemId;   // Item template, zero for a free slot
+    uint32 LastSeen; // Update sequence of the last time the item was updated
+    uint32 Time;     // Time of the last price sample
+    double Sum;      // Sum of the per unit prices, each weighted by its decay
+    double Weight;   // Sum of the weights of the samples, zero for no samples
+    uint64 Price;    // Market price of a single unit
+    uint32 Sold;     // Auctions of the bots sold, since the startup (table of the outcomes only)
+    uint32 Expired;  // Auctions of the bots expired unsold, since the startup (table of the outcomes only)
+    bool   Dirty;    // Changed since it was last saved
+};
+
+class AHBMarket
+{
+private:
+    std::vector<AHBMarketEntry> _slots;
+    uint32                      _size;
+    uint32                      _limit;
+    uint32                      _clock;
+    std::vector<uint32>         _dirty;
+    std::vector<AHBMarketEntry> _pending; // Records dropped while still to be saved
+
+    uint32 Slot(uint32 itemId) const;
+    void   Rehash(uint32 capacity);
+    void   Evict(uint32 count);
+    void   Release(AHBMarketEntry& entry);
+
+public:
+    AHBMarket();
+
+    AHBMarketEntry const* Find(uint32 itemId) const;
+    AHBMarketEntry&       Update(uint32 itemId);
+
+    void   SetLimit(uint32 limit);
+    void   Clear();
+
+    uint32 Size() const;
+
+    //
+    // Tracking of the records to save
+    //
+
+    void   MarkDirty(AHBMarketEntry& entry);
+    uint32 GetDirtyCount() const;
+    std::vector<AHBMarketEntry> TakeDirty();
+};
+
+#endif // AUCTION_HOUSE_BOT_MARKET_H
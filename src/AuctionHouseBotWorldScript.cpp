@@ -2,10 +2,15 @@
  * Copyright (C) 2016+ AzerothCore <www.azerothcore.org>, released under GNU AGPL v3 license: https://github.com/azerothcore/azerothcore-wotlk/blob/master/LICENSE
  */
 
+#include <exception>
+#include <thread>
+
+#include "AuctionHouseMgr.h"
 #include "Config.h"
 #include "Log.h"
 
 #include "AuctionHouseBot.h"
+#include "AuctionHouseBotBinsCache.h"
 #include "AuctionHouseBotCommon.h"
 #include "AuctionHouseBotWorldScript.h"
 
@@ -15,7 +20,8 @@
 
 AHBot_WorldScript::AHBot_WorldScript() : WorldScript("AHBot_WorldScript", {
     WORLDHOOK_ON_BEFORE_CONFIG_LOAD,
-    WORLDHOOK_ON_STARTUP
+    WORLDHOOK_ON_STARTUP,
+    WORLDHOOK_ON_SHUTDOWN
 })
 {
 
@@ -27,10 +33,18 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
     // Retrieve how many bots shall be operating on the auction market
     //
 
+    std::set<uint32> previousBotsId = gBotsId;
+
     bool   debug   = sConfigMgr->GetOption<bool>  ("AuctionHouseBot.DEBUG"  , false);
     uint32 account = sConfigMgr->GetOption<uint32>("AuctionHouseBot.Account", 0);
     uint32 player  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.GUID"   , 0);
 
+    //
+    // Time available to all the bots in a single auction house update
+    //
+
+    gTickBudgetUs  = sConfigMgr->GetOption<uint32>("AuctionHouseBot.TickBudgetUs", 0);
+
     //
     // All the bots bound to the provided account will be used for auctioning, if GUID is zero.
     // Otherwise only the specified character is used.
@@ -86,6 +100,8 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
         }
     }
 
+    RetireBots(previousBotsId);
+
     if (gBotsId.size() == 0)
     {
         LOG_ERROR("server.loading", "AHBot: no characters registered for account {}", account);
@@ -104,24 +120,38 @@ void AHBot_WorldScript::OnBeforeConfigLoad(bool reload)
         }
 
         //
-        // Clear the bots array; this way they wont be used anymore during the initialization stage.
+        // Build the new configurations aside, while the current ones stay in use
         //
 
-        DeleteBots();
+        AHBConfig* allianceConfig = new AHBConfig(2);
+        AHBConfig* hordeConfig    = new AHBConfig(6);
+        AHBConfig* neutralConfig  = new AHBConfig(7);
 
-        //
-        // Reload the configuration for the auction houses
-        //
+        InitializeConfigs(allianceConfig, hordeConfig, neutralConfig);
 
-        gAllianceConfig->Initialize(gBotsId);
-        gHordeConfig->Initialize   (gBotsId);
-        gNeutralConfig->Initialize (gBotsId);
+        allianceConfig->CarryOverMarket(gAllianceConfig);
+        hordeConfig   ->CarryOverMarket(gHordeConfig);
+        neutralConfig ->CarryOverMarket(gNeutralConfig);
 
         //
-        // Start again the bots
+        // Publish the new configurations and hand them to the bots. The reload and the auction house
+        // updates both run on the world thread, so no bot is in the middle of a cycle here and the
+        // old configurations can be released right away.
         //
 
+        AHBConfig* oldAllianceConfig = gAllianceConfig;
+        AHBConfig* oldHordeConfig    = gHordeConfig;
+        AHBConfig* oldNeutralConfig  = gNeutralConfig;
+
+        gAllianceConfig = allianceConfig;
+        gHordeConfig    = hordeConfig;
+        gNeutralConfig  = neutralConfig;
+
         PopulateBots();
+
+        delete oldAllianceConfig;
+        delete oldHordeConfig;
+        delete oldNeutralConfig;
     }
 }
 
@@ -133,9 +163,14 @@ void AHBot_WorldScript::OnStartup()
     // Initialize the configuration (done only once at startup)
     //
 
-    gAllianceConfig->Initialize(gBotsId);
-    gHordeConfig->Initialize   (gBotsId);
-    gNeutralConfig->Initialize (gBotsId);
+    InitializeConfigs(gAllianceConfig, gHordeConfig, gNeutralConfig);
+
+    //
+    // Restore the market prices learned before the restart, replacing the ones seeded from the live
+    // auctions; on reload they are carried over instead
+    //
+
+    AHBConfig::LoadMarkets({ gAllianceConfig, gHordeConfig, gNeutralConfig });
 
     //
     // Starts the bots
@@ -144,51 +179,271 @@ void AHBot_WorldScript::OnStartup()
     PopulateBots();
 }
 
-void AHBot_WorldScript::DeleteBots()
+void AHBot_WorldScript::OnShutdown()
 {
-    // 
-    // Save the old bots references.
-    // 
+    //
+    // Save the market prices not yet written
+    //
 
-    std::set<AuctionHouseBot*> oldBots;
+    gAllianceConfig->SaveMarket(true);
+    gHordeConfig   ->SaveMarket(true);
+    gNeutralConfig ->SaveMarket(true);
 
-    for (AuctionHouseBot* bot: gBots)
+    //
+    // Delete the items of the bots auctions expired after the last update
+    //
+
+    FlushDisposedItems(true);
+}
+
+void AHBot_WorldScript::InitializeConfigs(AHBConfig* allianceConfig, AHBConfig* hordeConfig, AHBConfig* neutralConfig)
+{
+    std::vector<AHBConfig*> configs = { allianceConfig, hordeConfig, neutralConfig };
+
+    //
+    // Load the options from the configuration file
+    //
+
+    for (AHBConfig* config : configs)
     {
-        oldBots.insert(bot);
+        config->InitializeFromFile();
     }
 
     //
-    // Clear the bot list
+    // Load the settings of all the auction houses with a single query
     //
 
-    gBots.clear();
+    AHBConfig::LoadSettings(configs);
 
-    // 
-    // Free the resources used up by the old bots
-    // 
+    //
+    // Load the sources of the items and the bins from the cache, when enabled and still matching the tables
+    //
+
+    std::string cacheFile  = sConfigMgr->GetOption<std::string>("AuctionHouseBot.BinsCacheFile", "");
+    uint64      sourcesKey = 0;
+    bool        cached     = false;
 
-    for (AuctionHouseBot* bot: oldBots)
+    std::shared_ptr<AHBSources const>                sources;
+    std::map<uint64, std::shared_ptr<AHBBins const>> cachedBins;
+
+    if (!cacheFile.empty())
     {
-        delete bot;
+        sourcesKey = AHBBinsCache::GetSourcesKey(neutralConfig->Profession_Items);
+
+        cached     = AHBBinsCache::Load(cacheFile, sourcesKey, sources, cachedBins);
+    }
+
+    //
+    // Otherwise load the sources of the items once, they are the same for all the auction houses
+    //
+
+    if (!sources)
+    {
+        sources = AHBConfig::LoadSources(neutralConfig->Profession_Items, neutralConfig->DebugOutConfig);
+    }
+
+    for (AHBConfig* config : configs)
+    {
+        config->SetSources(sources);
+    }
+
+    for (std::map<uint64, std::shared_ptr<AHBBins const>>::const_iterator it = cachedBins.begin(); it != cachedBins.end(); ++it)
+    {
+        AHBConfig::RegisterBins(it->first, sources, it->second);
+    }
+
+    //
+    // Update the situation of the markets
+    //
+
+    AHBConfig::InitializeFromSql(configs, gBotsId);
+
+    //
+    // Build the bins concurrently, once for each distinct set of filters: each pass only reads the
+    // item templates and the shared sources. The houses with the same filters share the bins
+    // already built when they initialize afterwards.
+    //
+
+    std::set<uint64>                filters;
+    std::vector<AHBConfig*>         sharing;
+    std::vector<std::thread>        workers;
+    std::vector<std::exception_ptr> errors(configs.size());
+
+    for (uint32 i = 0; i < configs.size(); i++)
+    {
+        AHBConfig* config = configs[i];
+
+        if (!filters.insert(config->GetFiltersHash()).second)
+        {
+            sharing.push_back(config);
+            continue;
+        }
+
+        //
+        // An exception escaping a thread terminates the server: it is kept and thrown again once all the
+        // workers are done, and the house left without bins does not sell meanwhile
+        //
+
+        workers.emplace_back([config, &error = errors[i]]()
+        {
+            try
+            {
+                config->InitializeBins();
+            }
+            catch (std::exception const& e)
+            {
+                LOG_ERROR("module", "AHBot: building the bins of ah {} failed: {}", config->GetAHID(), e.what());
+
+                config->AHBSeller = false;
+                error             = std::current_exception();
+            }
+            catch (...)
+            {
+                LOG_ERROR("module", "AHBot: building the bins of ah {} failed", config->GetAHID());
+
+                config->AHBSeller = false;
+                error             = std::current_exception();
+            }
+        });
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (std::exception_ptr const& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    for (AHBConfig* config : sharing)
+    {
+        config->InitializeBins();
+    }
+
+    //
+    // Refresh the cache if something had to be built
+    //
+
+    if (!cacheFile.empty() && sourcesKey != 0)
+    {
+        std::map<uint64, std::shared_ptr<AHBBins const>> bins;
+
+        for (AHBConfig* config : configs)
+        {
+            if (config->Bins)
+            {
+                bins[config->GetFiltersHash()] = config->Bins;
+            }
+        }
+
+        if (!cached || bins != cachedBins)
+        {
+            AHBBinsCache::Save(cacheFile, sourcesKey, *sources, bins);
+        }
     }
 }
 
+void AHBot_WorldScript::RetireBots(std::set<uint32> const& previousBotsId)
+{
+    //
+    // The bots removed by a reload may still own auctions: they are still recognized as bots until
+    // those auctions are gone, so that their items keep being disposed of instead of being mailed
+    //
+
+    for (uint32 id : gBotsId)
+    {
+        gRetiredBots.erase(id);
+    }
+
+    std::set<uint32> removed;
+
+    for (uint32 id : previousBotsId)
+    {
+        if (gBotsId.find(id) == gBotsId.end())
+        {
+            removed.insert(id);
+        }
+    }
+
+    if (removed.empty())
+    {
+        return;
+    }
+
+    std::set<AuctionHouseObject*> houses;
+
+    for (AHBConfig* config : { gAllianceConfig, gHordeConfig, gNeutralConfig })
+    {
+        AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+        if (!houses.insert(auctionHouse).second)
+        {
+            continue;
+        }
+
+        for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = auctionHouse->GetAuctionsBegin(); itr != auctionHouse->GetAuctionsEnd(); ++itr)
+        {
+            uint32 owner = itr->second->owner.GetCounter();
+
+            if (removed.find(owner) != removed.end())
+            {
+                ++gRetiredBots[owner];
+            }
+        }
+    }
+}
 
 void AHBot_WorldScript::PopulateBots()
 {
     uint32 account = sConfigMgr->GetOption<uint32>("AuctionHouseBot.Account", 0);
 
+    //
+    // Keep the bots still configured, with their timers and players, and release the others
+    //
+
+    std::set<AuctionHouseBot*> bots;
+    std::set<uint32>           running;
+
+    for (AuctionHouseBot* bot: gBots)
+    {
+        if (bot->GetAccount() == account && gBotsId.count(bot->GetAHBplayerGUID()) != 0)
+        {
+            bot->Initialize(gAllianceConfig, gHordeConfig, gNeutralConfig);
+
+            bots.insert(bot);
+            running.insert(bot->GetAHBplayerGUID());
+        }
+        else
+        {
+            delete bot;
+        }
+    }
+
     // 
-    // Insert the bot in the list used for auction house iterations
+    // Start the bots added to the configuration
     // 
 
-    gBots.clear();
-
     for (uint32 id: gBotsId)
     {
+        if (running.count(id) != 0)
+        {
+            continue;
+        }
+
         AuctionHouseBot* bot = new AuctionHouseBot(account, id);
         bot->Initialize(gAllianceConfig, gHordeConfig, gNeutralConfig);
 
-        gBots.insert(bot);
+        bots.insert(bot);
     }
+
+    //
+    // Insert the bots in the list used for auction house iterations
+    //
+
+    gBots = bots;
 }
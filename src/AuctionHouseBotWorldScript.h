@@ -7,6 +7,8 @@
 
 #include "ScriptMgr.h"
 
+#include "AuctionHouseBotConfig.h"
+
 // =============================================================================
 // Interaction with the world core mechanisms
 // =============================================================================
@@ -14,14 +16,16 @@
 class AHBot_WorldScript : public WorldScript
 {
 private:
-    void DeleteBots();
+    void InitializeConfigs(AHBConfig* allianceConfig, AHBConfig* hordeConfig, AHBConfig* neutralConfig);
     void PopulateBots();
+    void RetireBots(std::set<uint32> const& previousBotsId);
 
 public:
     AHBot_WorldScript();
 
     void OnBeforeConfigLoad(bool reload) override;
     void OnStartup() override;
+    void OnShutdown() override;
 };
 
 #endif /* AUCTION_HOUSE_BOT_WORLD_SCRIPT_H */
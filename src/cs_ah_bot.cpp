@@ -80,6 +80,19 @@ private:
         return static_cast<ItemQualities>(-1); // Invalid
     }
 
+    static char const* categoryName(uint32 category)
+    {
+        static char const* names[AHB_CATEGORIES] =
+        {
+            "grey   trade goods", "white  trade goods", "green  trade goods", "blue   trade goods",
+            "purple trade goods", "orange trade goods", "yellow trade goods",
+            "grey   items"      , "white  items"      , "green  items"      , "blue   items"      ,
+            "purple items"      , "orange items"      , "yellow items"
+        };
+
+        return category < AHB_CATEGORIES ? names[category] : "unknown";
+    }
+
 public:
     ah_bot_commandscript() : CommandScript("ah_bot_commandscript")
     {
@@ -166,6 +179,154 @@ public:
 
             return true;
         }
+        else if (strncmp(opt, "stats", l) == 0)
+        {
+            //
+            // Reports how many times the bots players have been built and reused, and the time saved by
+            // each reuse: a build and a destruction, as measured on the players actually built and destroyed
+            //
+
+            uint64 builds    = 0;
+            uint64 reuses    = 0;
+            uint64 buildUs   = 0;
+            uint64 destroys  = 0;
+            uint64 destroyUs = 0;
+
+            for (AuctionHouseBot* bot : gBots)
+            {
+                builds    += bot->GetActorBuilds();
+                reuses    += bot->GetActorReuses();
+                buildUs   += bot->GetActorBuildUs();
+                destroys  += bot->GetActorDestroys();
+                destroyUs += bot->GetActorDestroyUs();
+            }
+
+            uint64 avgBuildUs   = builds   > 0 ? buildUs   / builds   : 0;
+            uint64 avgDestroyUs = destroys > 0 ? destroyUs / destroys : 0;
+            uint64 savedUs      = (avgBuildUs + avgDestroyUs) * reuses;
+
+            handler->PSendSysMessage("AHBot stats: {} bots, {} players built, {} players reused, {} players destroyed", gBots.size(), builds, reuses, destroys);
+            handler->PSendSysMessage("AHBot stats: {} us per build, {} us per destruction", avgBuildUs, avgDestroyUs);
+            handler->PSendSysMessage("AHBot stats: about {} us saved over {} updates, {} us per update", savedUs, gTicks, gTicks > 0 ? savedUs / gTicks : 0);
+
+            return true;
+        }
+        else if (strncmp(opt, "census", l) == 0)
+        {
+            //
+            // Reports the auctions of each auction house by category, split between the bots and the players
+            //
+
+            std::set<AuctionHouseObject*> houses;
+
+            for (AHBConfig* config : { gAllianceConfig, gHordeConfig, gNeutralConfig })
+            {
+                AuctionHouseObject* auctionHouse = sAuctionMgr->GetAuctionsMap(config->GetAHFID());
+
+                if (!houses.insert(auctionHouse).second)
+                {
+                    continue;
+                }
+
+                AHBCensus census = AHBConfig::TakeCensus(auctionHouse, gBotsId, {});
+
+                handler->PSendSysMessage("AHBot census for ah {}: {} auctions", config->GetAHID(), auctionHouse->Getcount());
+
+                for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+                {
+                    handler->PSendSysMessage("  {}: {} bots, {} players", categoryName(category), census.BotAuctions[category], census.PlayerAuctions[category]);
+                }
+            }
+
+            return true;
+        }
+        else if (strncmp(opt, "expiries", l) == 0)
+        {
+            //
+            // Reports how the expirations of the bots auctions are spread over time, by hour from now
+            //
+
+            uint32 now = uint32(time(NULL));
+
+            for (AHBConfig* config : { gAllianceConfig, gHordeConfig, gNeutralConfig })
+            {
+                std::map<uint32, uint32> const& distribution = config->GetExpiryDistribution();
+
+                std::map<uint32, std::pair<uint32, uint32>> hours; // Hour from now -> (auctions, peak per minute)
+
+                uint32 total      = 0;
+                uint32 peak       = 0;
+                uint32 peakMinute = 0;
+                uint32 overCap    = 0;
+
+                for (std::map<uint32, uint32>::const_iterator it = distribution.begin(); it != distribution.end(); ++it)
+                {
+                    uint32 expiry = it->first * MINUTE;
+                    uint32 hour   = expiry > now ? (expiry - now) / HOUR : 0;
+
+                    total += it->second;
+
+                    if (it->second > peak)
+                    {
+                        peak       = it->second;
+                        peakMinute = expiry > now ? (expiry - now) / MINUTE : 0;
+                    }
+
+                    if (config->ExpiryPerMinute > 0 && it->second > config->ExpiryPerMinute)
+                    {
+                        overCap++;
+                    }
+
+                    hours[hour].first  += it->second;
+                    hours[hour].second  = std::max(hours[hour].second, it->second);
+                }
+
+                handler->PSendSysMessage("AHBot expiries for ah {}: {} auctions over {} minutes, peak of {} in {} minutes, {} minutes above the cap",
+                    config->GetAHID(), total, distribution.size(), peak, peakMinute, overCap);
+
+                for (std::map<uint32, std::pair<uint32, uint32>>::const_iterator it = hours.begin(); it != hours.end(); ++it)
+                {
+                    handler->PSendSysMessage("  hour {}: {} auctions, at most {} in one minute", it->first, it->second.first, it->second.second);
+                }
+            }
+
+            return true;
+        }
+        else if (strncmp(opt, "sellthrough", l) == 0)
+        {
+            //
+            // Reports the outcome of the bots auctions of each auction house by category: every listing
+            // not sold is an auction, an item and a mail written and then deleted for nothing
+            //
+
+            for (AHBConfig* config : { gAllianceConfig, gHordeConfig, gNeutralConfig })
+            {
+                uint32 listed  = 0;
+                uint32 sold    = 0;
+                uint32 expired = 0;
+
+                for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+                {
+                    listed  += config->GetListed(category);
+                    sold    += config->GetSold(category);
+                    expired += config->GetExpired(category);
+                }
+
+                handler->PSendSysMessage("AHBot sell-through for ah {}: {} listed, {} sold, {} expired, {:.2f} listings per sale",
+                    config->GetAHID(), listed, sold, expired, sold > 0 ? double(listed) / sold : 0.0);
+
+                for (uint32 category = 0; category < AHB_CATEGORIES; category++)
+                {
+                    uint32 categorySold = config->GetSold(category);
+
+                    handler->PSendSysMessage("  {}: {} listed, {} sold, {} expired, {:.2f} listings per sale",
+                        categoryName(category), config->GetListed(category), categorySold, config->GetExpired(category),
+                        categorySold > 0 ? double(config->GetListed(category)) / categorySold : 0.0);
+                }
+            }
+
+            return true;
+        }
 
         //
         // Retrieve the auction house type
@@ -209,6 +370,10 @@ public:
             handler->PSendSysMessage("buyer - enable/disable buyer");
             handler->PSendSysMessage("seller - enable/disabler seller");
             handler->PSendSysMessage("usemarketprice - enable/disabler selling at market price");
+            handler->PSendSysMessage("stats - show the bots players reuse statistics");
+            handler->PSendSysMessage("census - show the auctions by category of each auction house");
+            handler->PSendSysMessage("sellthrough - show how many bots auctions sold or expired, by category");
+            handler->PSendSysMessage("expiries - show how the expirations of the bots auctions are spread over time");
             handler->PSendSysMessage("ahexpire - remove all bot auctions");
             handler->PSendSysMessage("minitems - set min auctions");
             handler->PSendSysMessage("maxitems - set max auctions");